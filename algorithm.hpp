@@ -0,0 +1,92 @@
+#ifndef ALGORITHM_HPP
+#define ALGORITHM_HPP
+
+#include <iterator>
+#include <tuple>
+#include <utility>
+
+#include "chain_range.hpp"
+#include "flatten_range.hpp"
+#include "range.hpp"
+#include "static_range.hpp"
+#include "unroll_range.hpp"
+
+namespace shake {
+
+namespace algorithm_detail {
+
+//----------------------------------------------------------------
+template<typename range_t>
+using iterator_t = decltype( std::begin( std::declval<range_t&>() ) );
+
+// Calls the function on each element of the range, in order.
+// Unrolled ranges are processed in blocks of their unroll factor with a single end check per block,
+// after which the remaining elements are processed one at a time.
+// Chained and flattened ranges are processed segment by segment, so each segment gets a loop of its own.
+template<typename range_t, typename function_t>
+constexpr void visit( range_t&& input_range, function_t& function )
+{
+    if constexpr ( is_chain_iterator_v<iterator_t<range_t>> )
+    {
+        std::apply( [ & ]( const auto&... segment ) { ( visit( segment, function ), ... ); }, segments( input_range ) );
+    }
+    else if constexpr ( is_flatten_iterator_v<iterator_t<range_t>> )
+    {
+        for_each_segment( input_range, [ & ]( const auto& segment ) { visit( segment, function ); } );
+    }
+    else if constexpr ( is_unroll_iterator_v<iterator_t<range_t>> )
+    {
+        constexpr auto factor = static_cast<std::ptrdiff_t>( iterator_t<range_t>::factor );
+
+        // the size comes from both ends, since a part of an unrolled range, like one from split, ends before the whole range
+        const auto begin    = std::begin( input_range );
+        auto it             = begin.get_internal_iterator();
+        auto n_remaining    = std::end( input_range ) - begin;
+        for ( ; n_remaining >= factor; n_remaining -= factor )
+        {
+            static_for<factor>( [ & ]( auto ) { function( *it ); ++it; } );
+        }
+        for ( ; n_remaining > 0; --n_remaining )
+        {
+            function( *it );
+            ++it;
+        }
+    }
+    else
+    {
+        for ( auto&& element : input_range )
+        {
+            function( element );
+        }
+    }
+}
+
+} // namespace algorithm_detail
+
+//----------------------------------------------------------------
+// Calls the function on each element of the range, and returns the function, like std::for_each.
+template<typename range_t, typename function_t>
+constexpr function_t for_each( range_t&& input_range, function_t function )
+{
+    algorithm_detail::visit( std::forward<range_t>( input_range ), function );
+    return function;
+}
+
+//----------------------------------------------------------------
+// Folds the elements of the range from left to right, like std::accumulate.
+// Elements are combined in order, also for unrolled ranges, so the result is the same as that of a plain loop.
+template<typename range_t, typename value_t, typename operation_t>
+constexpr value_t reduce( range_t&& input_range, value_t initial_value, operation_t operation )
+{
+    auto result = std::move( initial_value );
+    auto accumulate = [ & ]( auto&& element )
+    {
+        result = operation( std::move( result ), std::forward<decltype( element )>( element ) );
+    };
+    algorithm_detail::visit( std::forward<range_t>( input_range ), accumulate );
+    return result;
+}
+
+} // namespace shake
+
+#endif // ALGORITHM_HPP
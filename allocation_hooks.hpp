@@ -0,0 +1,64 @@
+#ifndef ALLOCATION_HOOKS_HPP
+#define ALLOCATION_HOOKS_HPP
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+#include "allocation_tracking.hpp"
+
+//----------------------------------------------------------------
+// Replaces the global operator new and delete, to count allocations in the test and benchmark executables.
+// Replacements can not be inline, so this should be included in exactly one translation unit.
+// The nothrow versions of operator new call these, so they are counted as well.
+
+namespace shake {
+namespace allocation_tracking {
+
+// Not inlined, so that the compiler does not see malloc and free paired with new and delete
+[[gnu::noinline]] inline void* allocate( std::size_t size, std::size_t alignment = 0 )
+{
+    ++n_allocations;
+    // allocating zero bytes should still return a unique pointer
+    size = size > 0 ? size : 1;
+    void* memory = nullptr;
+    if ( alignment > alignof( std::max_align_t ) )
+    {
+        memory = std::aligned_alloc( alignment, ( size + alignment - 1 ) / alignment * alignment );
+    }
+    else
+    {
+        memory = std::malloc( size );
+    }
+    if ( memory == nullptr )
+    {
+        throw std::bad_alloc { };
+    }
+    return memory;
+}
+
+[[gnu::noinline]] inline void deallocate( void* memory ) noexcept
+{
+    std::free( memory );
+}
+
+static const bool hooks_installed_initializer = ( are_hooks_installed = true );
+
+} // namespace allocation_tracking
+} // namespace shake
+
+void* operator new      ( std::size_t size )                            { return shake::allocation_tracking::allocate( size ); }
+void* operator new[]    ( std::size_t size )                            { return shake::allocation_tracking::allocate( size ); }
+void* operator new      ( std::size_t size, std::align_val_t alignment ) { return shake::allocation_tracking::allocate( size, static_cast<std::size_t>( alignment ) ); }
+void* operator new[]    ( std::size_t size, std::align_val_t alignment ) { return shake::allocation_tracking::allocate( size, static_cast<std::size_t>( alignment ) ); }
+
+void operator delete    ( void* memory ) noexcept                                       { shake::allocation_tracking::deallocate( memory ); }
+void operator delete[]  ( void* memory ) noexcept                                       { shake::allocation_tracking::deallocate( memory ); }
+void operator delete    ( void* memory, std::size_t ) noexcept                          { shake::allocation_tracking::deallocate( memory ); }
+void operator delete[]  ( void* memory, std::size_t ) noexcept                          { shake::allocation_tracking::deallocate( memory ); }
+void operator delete    ( void* memory, std::align_val_t ) noexcept                     { shake::allocation_tracking::deallocate( memory ); }
+void operator delete[]  ( void* memory, std::align_val_t ) noexcept                     { shake::allocation_tracking::deallocate( memory ); }
+void operator delete    ( void* memory, std::size_t, std::align_val_t ) noexcept        { shake::allocation_tracking::deallocate( memory ); }
+void operator delete[]  ( void* memory, std::size_t, std::align_val_t ) noexcept        { shake::allocation_tracking::deallocate( memory ); }
+
+#endif // ALLOCATION_HOOKS_HPP
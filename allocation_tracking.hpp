@@ -0,0 +1,31 @@
+#ifndef ALLOCATION_TRACKING_HPP
+#define ALLOCATION_TRACKING_HPP
+
+#include <cstddef>
+#include <utility>
+
+namespace shake {
+namespace allocation_tracking {
+
+//----------------------------------------------------------------
+// The number of allocations made by the current thread, through the global operator new.
+// Only counted when allocation_hooks.hpp is included in the executable, which replaces operator new.
+inline thread_local std::size_t n_allocations = 0;
+
+// Set by allocation_hooks.hpp, so that zero allocations can be told apart from not counting at all
+inline bool are_hooks_installed = false;
+
+//----------------------------------------------------------------
+// Returns the number of allocations the current thread made while calling the function.
+template<typename function_t>
+std::size_t count_allocations( function_t&& function )
+{
+    const auto n_allocations_before = n_allocations;
+    std::forward<function_t>( function )();
+    return n_allocations - n_allocations_before;
+}
+
+} // namespace allocation_tracking
+} // namespace shake
+
+#endif // ALLOCATION_TRACKING_HPP
@@ -4,6 +4,7 @@
 #include <functional>
 #include <any>
 
+#include "instrumentation.hpp"
 #include "range.hpp"
 
 namespace shake {
@@ -21,7 +22,8 @@ class AnyIterator
 {
 public:
     // iterator traits
-    using iterator_category = std::random_access_iterator_tag;
+    // only incrementing is type erased, so this is a forward iterator whatever the wrapped iterator is
+    using iterator_category = std::forward_iterator_tag;
     using value_type        = data_t;
     using difference_type   = std::ptrdiff_t;
     using pointer           = data_t*;
@@ -54,6 +56,8 @@ public:
 
     AnyIterator& operator++()
     {
+        SHAKE_COUNT_OPERATION( AnyIterator, "AnyIterator", increments );
+        SHAKE_COUNT_OPERATION( AnyIterator, "AnyIterator", invocations );
         // Simply call type-erased replacement
         m_type_erased_functions.preincrement( m_wrapped_iterator );
         return *this;
@@ -68,6 +72,8 @@ public:
 
     bool operator==( const AnyIterator& other ) const
     {
+        SHAKE_COUNT_OPERATION( AnyIterator, "AnyIterator", comparisons );
+        SHAKE_COUNT_OPERATION( AnyIterator, "AnyIterator", invocations );
         // Simply call type-erased replacement
         return m_type_erased_functions.equality( get_internal_iterator(), other.get_internal_iterator() );
     }
@@ -79,6 +85,8 @@ public:
 
     data_t operator*()
     {
+        SHAKE_COUNT_OPERATION( AnyIterator, "AnyIterator", dereferences );
+        SHAKE_COUNT_OPERATION( AnyIterator, "AnyIterator", invocations );
         // Simply call type-erased replacement
         return m_type_erased_functions.dereference( m_wrapped_iterator );
     }
@@ -86,6 +94,7 @@ public:
 public:
     std::any                m_wrapped_iterator;
     TypeErasedFunctions     m_type_erased_functions;
+    SHAKE_COUNT_COPIES( AnyIterator, "AnyIterator" );
 };
 
 //----------------------------------------------------------------
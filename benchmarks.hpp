@@ -0,0 +1,613 @@
+#ifndef BENCHMARKS_HPP
+#define BENCHMARKS_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "algorithm.hpp"
+#include "allocation_tracking.hpp"
+#include "any_range.hpp"
+#include "chain_range.hpp"
+#include "chunk_range.hpp"
+#include "combine_range.hpp"
+#include "flatten_range.hpp"
+#include "index_range.hpp"
+#include "merge_range.hpp"
+#include "perf_counters.hpp"
+#include "prefetch_ahead_range.hpp"
+#include "range.hpp"
+#include "sample_range.hpp"
+#include "set_range.hpp"
+#include "step_range.hpp"
+#include "tiled_range.hpp"
+#include "transform_range.hpp"
+#include "unroll_range.hpp"
+#include "window_range.hpp"
+
+namespace shake {
+namespace benchmarks {
+
+//----------------------------------------------------------------
+// Prevents the compiler from optimizing away the computation of a value
+template<typename T>
+inline void do_not_optimize( const T& value )
+{
+    asm volatile( "" : : "r,m"( value ) : "memory" );
+}
+
+//----------------------------------------------------------------
+inline void print_header()
+{
+    std::cout << std::left << std::setw( 32 ) << "benchmark" << std::right;
+    for ( const auto* column : { "ns", "cycles", "instructions", "branch misses", "L1d misses", "LLC misses", "allocations" } )
+    {
+        std::cout << std::setw( 15 ) << column;
+    }
+    std::cout << "\n(per element)\n";
+}
+
+//----------------------------------------------------------------
+// Runs the function once to warm up, and then a number of times while measuring.
+// Reports wall-clock time, hardware counters and allocations per element,
+// or n/a for counters that are not accessible, or when allocations are not tracked.
+template<typename function_t>
+inline void run_benchmark( const std::string& name, std::size_t n_elements, function_t&& function )
+{
+    constexpr std::size_t n_repetitions = 10;
+    static auto counters = PerfCounters { };
+
+    function();
+
+    counters.start();
+    const auto begin = std::chrono::steady_clock::now();
+    const auto n_allocations = allocation_tracking::count_allocations( [ & ]()
+    {
+        for ( std::size_t i = 0; i < n_repetitions; ++i )
+        {
+            function();
+        }
+    } );
+    const auto end = std::chrono::steady_clock::now();
+    counters.stop();
+
+    const auto n_total = static_cast<double>( n_elements * n_repetitions );
+    const auto print_per_element = [ n_total ]( std::optional<double> value )
+    {
+        if ( value )
+        {
+            std::cout << std::setw( 15 ) << std::fixed << std::setprecision( 3 ) << *value / n_total;
+        }
+        else
+        {
+            std::cout << std::setw( 15 ) << "n/a";
+        }
+    };
+
+    std::cout << std::left << std::setw( 32 ) << name << std::right;
+    print_per_element( static_cast<double>( std::chrono::duration_cast<std::chrono::nanoseconds>( end - begin ).count() ) );
+    for ( const auto& value : counters.read() )
+    {
+        print_per_element( value ? std::optional<double> { static_cast<double>( *value ) } : std::nullopt );
+    }
+    print_per_element( allocation_tracking::are_hooks_installed ? std::optional<double> { static_cast<double>( n_allocations ) } : std::nullopt );
+    std::cout << "\n";
+}
+
+//----------------------------------------------------------------
+constexpr std::size_t n_elements = std::size_t { 1 } << 20;
+
+inline std::vector<int> make_ints()
+{
+    auto ints = std::vector<int>( n_elements );
+    std::iota( ints.begin(), ints.end(), 0 );
+    return ints;
+}
+
+//----------------------------------------------------------------
+// RAW LOOP, as a baseline for the ranges
+
+inline void benchmark_raw_loop()
+{
+    const auto ints = make_ints();
+    run_benchmark( "raw loop", n_elements, [ & ]()
+    {
+        auto sum = 0L;
+        for ( std::size_t i = 0; i < ints.size(); ++i )
+        {
+            sum += ints[ i ];
+        }
+        do_not_optimize( sum );
+    } );
+}
+
+//----------------------------------------------------------------
+// INDEX RANGE
+
+inline void benchmark_index_range()
+{
+    const auto ints = make_ints();
+    run_benchmark( "index range", n_elements, [ & ]()
+    {
+        auto sum = 0L;
+        for ( const auto& i : range( ints.size() ) )
+        {
+            sum += ints[ i ];
+        }
+        do_not_optimize( sum );
+    } );
+}
+
+//----------------------------------------------------------------
+// STEP RANGE
+
+inline void benchmark_step_range()
+{
+    const auto ints = make_ints();
+    run_benchmark( "step range", n_elements / 4, [ & ]()
+    {
+        auto sum = 0L;
+        for ( const auto& value : step( const_range( ints ), 4 ) )
+        {
+            sum += value;
+        }
+        do_not_optimize( sum );
+    } );
+}
+
+//----------------------------------------------------------------
+// COMBINE RANGE
+
+inline void benchmark_combine_range()
+{
+    const auto ints = make_ints();
+    const auto other_ints = make_ints();
+    run_benchmark( "combine range", n_elements, [ & ]()
+    {
+        auto sum = 0L;
+        for ( const auto& [ a, b ] : combine( const_range( ints ), const_range( other_ints ) ) )
+        {
+            sum += a * b;
+        }
+        do_not_optimize( sum );
+    } );
+}
+
+inline void benchmark_unrolled_combine_range()
+{
+    const auto ints = make_ints();
+    const auto other_ints = make_ints();
+    run_benchmark( "combine range, unrolled by 8", n_elements, [ & ]()
+    {
+        const auto sum = reduce( unroll<8>( combine( const_range( ints ), const_range( other_ints ) ) ), 0L, []( long partial, const auto& pair )
+        {
+            return partial + std::get<0>( pair ) * std::get<1>( pair );
+        } );
+        do_not_optimize( sum );
+    } );
+}
+
+//----------------------------------------------------------------
+// TRANSFORM RANGE
+
+inline void benchmark_transform_range()
+{
+    const auto ints = make_ints();
+    run_benchmark( "transform range", n_elements, [ & ]()
+    {
+        auto sum = 0L;
+        for ( const auto& value : transform<const int&, long>( const_range( ints ), []( const int& i ) -> long { return 2L * i; } ) )
+        {
+            sum += value;
+        }
+        do_not_optimize( sum );
+    } );
+}
+
+//----------------------------------------------------------------
+// ANY RANGE
+
+inline void benchmark_any_range()
+{
+    const auto ints = make_ints();
+    run_benchmark( "any range", n_elements, [ & ]()
+    {
+        auto sum = 0L;
+        for ( const auto& value : make_any_range( const_range( ints ) ) )
+        {
+            sum += value;
+        }
+        do_not_optimize( sum );
+    } );
+}
+
+//----------------------------------------------------------------
+// PREFETCH AHEAD RANGE
+
+// Returns the indices from 0 to n in a random order, which is the same for every run
+inline std::vector<std::size_t> make_shuffled_indices( std::size_t n )
+{
+    auto indices = std::vector<std::size_t>( n );
+    std::iota( indices.begin(), indices.end(), 0 );
+    std::shuffle( indices.begin(), indices.end(), std::mt19937_64 { 42 } );
+    return indices;
+}
+
+inline void benchmark_gather()
+{
+    // much larger than the last level cache, so that random accesses miss
+    const auto data = std::vector<long>( n_elements * 16, 1 );
+    const auto indices = make_shuffled_indices( data.size() );
+    run_benchmark( "indirect loop", indices.size(), [ & ]()
+    {
+        auto sum = 0L;
+        for ( const auto& index : indices )
+        {
+            sum += data[ index ];
+        }
+        do_not_optimize( sum );
+    } );
+    run_benchmark( "gather, prefetched ahead", indices.size(), [ & ]()
+    {
+        auto sum = 0L;
+        for ( const auto& value : gather( const_range( data ), const_range( indices ) ) )
+        {
+            sum += value;
+        }
+        do_not_optimize( sum );
+    } );
+}
+
+//----------------------------------------------------------------
+// TILED RANGE
+
+inline void benchmark_transpose()
+{
+    // each row is a multiple of a page, so that the columns of untiled loops conflict in the cache
+    constexpr std::size_t n = 2048;
+    const auto input = std::vector<double>( n * n, 1.0 );
+    auto output = std::vector<double>( n * n );
+    run_benchmark( "transpose", n * n, [ & ]()
+    {
+        for ( const auto& [ i, j ] : range_nd<2>( { n, n } ) )
+        {
+            output[ j * n + i ] = input[ i * n + j ];
+        }
+        do_not_optimize( output.data() );
+    } );
+    run_benchmark( "transpose, tiled", n * n, [ & ]()
+    {
+        for ( const auto& [ i, j ] : tiled( range_nd<2>( { n, n } ) ) )
+        {
+            output[ j * n + i ] = input[ i * n + j ];
+        }
+        do_not_optimize( output.data() );
+    } );
+}
+
+//----------------------------------------------------------------
+// CHAIN RANGE
+
+inline void benchmark_chain_range()
+{
+    const auto ints = make_ints();
+    const auto other_ints = make_ints();
+    const auto chained = chain( const_range( ints ), const_range( other_ints ) );
+    run_benchmark( "chain range", 2 * n_elements, [ & ]()
+    {
+        auto sum = 0L;
+        for ( const auto& value : chained )
+        {
+            sum += value;
+        }
+        do_not_optimize( sum );
+    } );
+    run_benchmark( "chain range, by segment", 2 * n_elements, [ & ]()
+    {
+        const auto sum = reduce( chained, 0L, []( long partial, int value ) { return partial + value; } );
+        do_not_optimize( sum );
+    } );
+}
+
+//----------------------------------------------------------------
+// FLATTEN RANGE
+
+inline void benchmark_flatten_range()
+{
+    // shards of varying sizes, some of them empty
+    auto shards = std::vector<std::vector<int>>( 4096 );
+    for ( std::size_t i = 0; i < shards.size(); ++i )
+    {
+        shards[ i ].resize( ( i % 3 ) * n_elements / shards.size() );
+    }
+    const auto n_total = flat_size( flatten( const_range( shards ) ) );
+    run_benchmark( "nested loops", n_total, [ & ]()
+    {
+        auto sum = 0L;
+        for ( const auto& shard : shards )
+        {
+            for ( const auto& value : shard )
+            {
+                sum += value;
+            }
+        }
+        do_not_optimize( sum );
+    } );
+    run_benchmark( "flatten range", n_total, [ & ]()
+    {
+        auto sum = 0L;
+        for ( const auto& value : flatten( const_range( shards ) ) )
+        {
+            sum += value;
+        }
+        do_not_optimize( sum );
+    } );
+    run_benchmark( "flatten range, by segment", n_total, [ & ]()
+    {
+        const auto sum = reduce( flatten( const_range( shards ) ), 0L, []( long partial, int value ) { return partial + value; } );
+        do_not_optimize( sum );
+    } );
+}
+
+//----------------------------------------------------------------
+// WINDOW RANGE
+
+inline void benchmark_moving_average()
+{
+    constexpr std::size_t window_size = 64;
+    const auto ints = make_ints();
+    const auto n_windows = n_elements - window_size + 1;
+    run_benchmark( "moving average, per window", n_windows, [ & ]()
+    {
+        auto sum = 0.0;
+        for ( const auto& window : windows( const_range( ints ), window_size ) )
+        {
+            sum += static_cast<double>( reduce( window, 0L, []( long partial, int value ) { return partial + value; } ) ) / window_size;
+        }
+        do_not_optimize( sum );
+    } );
+    run_benchmark( "moving average, rolling", n_windows, [ & ]()
+    {
+        auto sum = 0.0;
+        for ( const auto& mean : rolling( const_range( ints ), window_size, rolling_mean ) )
+        {
+            sum += mean;
+        }
+        do_not_optimize( sum );
+    } );
+    run_benchmark( "moving maximum, rolling", n_windows, [ & ]()
+    {
+        auto sum = 0L;
+        for ( const auto& maximum : rolling( const_range( ints ), window_size, rolling_max ) )
+        {
+            sum += maximum;
+        }
+        do_not_optimize( sum );
+    } );
+}
+
+//----------------------------------------------------------------
+// CHUNK RANGE
+
+inline void benchmark_chunk_by()
+{
+    // sorted keys, in runs of 256 equal keys
+    auto keys = std::vector<int>( n_elements );
+    for ( std::size_t i = 0; i < keys.size(); ++i )
+    {
+        keys[ i ] = static_cast<int>( i / 256 );
+    }
+    run_benchmark( "runs, by hand", n_elements, [ & ]()
+    {
+        auto n_runs = std::size_t { 0 };
+        for ( std::size_t i = 0; i < keys.size(); ++i )
+        {
+            n_runs += i == 0 || keys[ i ] != keys[ i - 1 ];
+        }
+        do_not_optimize( n_runs );
+    } );
+    run_benchmark( "runs, chunk_by key function", n_elements, [ & ]()
+    {
+        auto n_runs = std::size_t { 0 };
+        for ( const auto& [ key, run ] : chunk_by( const_range( keys ), []( int key ) { return key; } ) )
+        {
+            n_runs += key >= 0;
+        }
+        do_not_optimize( n_runs );
+    } );
+    run_benchmark( "runs, chunk_by SIMD scan", n_elements, [ & ]()
+    {
+        auto n_runs = std::size_t { 0 };
+        for ( const auto& [ key, run ] : chunk_by( const_range( keys ) ) )
+        {
+            n_runs += key >= 0;
+        }
+        do_not_optimize( n_runs );
+    } );
+}
+
+//----------------------------------------------------------------
+// MERGE RANGE
+
+inline void benchmark_merge()
+{
+    // sorted shards of random values
+    constexpr std::size_t n_shards = 32;
+    auto shards = std::vector<std::vector<int>>( n_shards );
+    auto random = std::mt19937_64 { 42 };
+    for ( auto& shard : shards )
+    {
+        shard.resize( n_elements / n_shards );
+        for ( auto& i : shard )
+        {
+            i = static_cast<int>( random() % n_elements );
+        }
+        std::sort( shard.begin(), shard.end() );
+    }
+    auto shard_ranges = std::vector<Range<std::vector<int>::const_iterator>> { };
+    for ( const auto& shard : shards )
+    {
+        shard_ranges.push_back( const_range( shard ) );
+    }
+    run_benchmark( "32 shards, collect and sort", n_elements, [ & ]()
+    {
+        auto ints = std::vector<int> { };
+        for ( const auto& shard : shards )
+        {
+            ints.insert( ints.end(), shard.begin(), shard.end() );
+        }
+        std::sort( ints.begin(), ints.end() );
+        do_not_optimize( ints.data() );
+    } );
+    run_benchmark( "32 shards, merge", n_elements, [ & ]()
+    {
+        auto sum = 0L;
+        for ( const auto& i : merge( shard_ranges ) )
+        {
+            sum += i;
+        }
+        do_not_optimize( sum );
+    } );
+    run_benchmark( "32 shards, stable merge", n_elements, [ & ]()
+    {
+        auto sum = 0L;
+        for ( const auto& i : stable_merge( shard_ranges ) )
+        {
+            sum += i;
+        }
+        do_not_optimize( sum );
+    } );
+}
+
+//----------------------------------------------------------------
+// SET RANGE
+
+inline void benchmark_set_intersection()
+{
+    // posting lists of document ids, with a size difference of 1000 times
+    auto random = std::mt19937_64 { 42 };
+    const auto make_posting_list = [ & ]( std::size_t size )
+    {
+        auto ids = std::vector<std::uint32_t>( size );
+        for ( auto& id : ids )
+        {
+            id = static_cast<std::uint32_t>( random() % ( 16 * n_elements ) );
+        }
+        std::sort( ids.begin(), ids.end() );
+        return ids;
+    };
+    const auto rare = make_posting_list( n_elements / 1000 );
+    const auto common = make_posting_list( n_elements );
+    const auto other_common = make_posting_list( n_elements );
+    const auto count_matches = []( const auto& first, const auto& second )
+    {
+        auto n_matches = std::size_t { 0 };
+        for ( const auto& id : set_intersection( const_range( first ), const_range( second ) ) )
+        {
+            n_matches += id > 0;
+        }
+        do_not_optimize( n_matches );
+    };
+    auto matches = std::vector<std::uint32_t>( n_elements );
+    const auto count_matches_linearly = [ & ]( const auto& first, const auto& second )
+    {
+        const auto n_matches = std::set_intersection( first.begin(), first.end(), second.begin(), second.end(), matches.begin() ) - matches.begin();
+        do_not_optimize( n_matches );
+    };
+    run_benchmark( "skewed, std::set_intersection", n_elements, [ & ]() { count_matches_linearly( rare, common ); } );
+    run_benchmark( "skewed, set_intersection", n_elements, [ & ]() { count_matches( rare, common ); } );
+    run_benchmark( "balanced, std::set_intersection", 2 * n_elements, [ & ]() { count_matches_linearly( common, other_common ); } );
+    run_benchmark( "balanced, set_intersection", 2 * n_elements, [ & ]() { count_matches( common, other_common ); } );
+}
+
+//----------------------------------------------------------------
+// SAMPLE RANGE
+
+inline void benchmark_sampling()
+{
+    const auto ints = make_ints();
+    run_benchmark( "reservoir, a draw per element", n_elements, [ & ]()
+    {
+        // Algorithm R, for comparison
+        constexpr std::size_t k = 100;
+        auto engine = std::mt19937_64 { 42 };
+        auto reservoir = std::vector<int>( ints.begin(), ints.begin() + k );
+        for ( std::size_t i = k; i < ints.size(); ++i )
+        {
+            const auto slot = std::uniform_int_distribution<std::size_t> { 0, i }( engine );
+            if ( slot < k )
+            {
+                reservoir[ slot ] = ints[ i ];
+            }
+        }
+        do_not_optimize( reservoir.data() );
+    } );
+    run_benchmark( "reservoir, sample", n_elements, [ & ]()
+    {
+        const auto reservoir = sample( const_range( ints ), 100, std::mt19937_64 { 42 } );
+        do_not_optimize( reservoir.data() );
+    } );
+    run_benchmark( "bernoulli 1%, a draw per element", n_elements, [ & ]()
+    {
+        auto engine = std::mt19937_64 { 42 };
+        auto coin = std::bernoulli_distribution { 0.01 };
+        auto sum = 0L;
+        for ( const auto& value : ints )
+        {
+            if ( coin( engine ) )
+            {
+                sum += value;
+            }
+        }
+        do_not_optimize( sum );
+    } );
+    run_benchmark( "bernoulli 1%, geometric skips", n_elements, [ & ]()
+    {
+        auto sum = 0L;
+        for ( const auto& value : bernoulli( const_range( ints ), 0.01, std::mt19937_64 { 42 } ) )
+        {
+            sum += value;
+        }
+        do_not_optimize( sum );
+    } );
+}
+
+//----------------------------------------------------------------
+inline void run()
+{
+    if ( !PerfCounters { }.is_available() )
+    {
+        std::cout << "hardware performance counters are not accessible, only reporting wall-clock time\n";
+    }
+    print_header();
+
+    benchmark_raw_loop();
+    benchmark_index_range();
+    benchmark_step_range();
+    benchmark_combine_range();
+    benchmark_unrolled_combine_range();
+    benchmark_transform_range();
+    benchmark_any_range();
+    benchmark_gather();
+    benchmark_transpose();
+    benchmark_chain_range();
+    benchmark_flatten_range();
+    benchmark_moving_average();
+    benchmark_chunk_by();
+    benchmark_merge();
+    benchmark_set_intersection();
+    benchmark_sampling();
+}
+
+} // benchmarks
+} // namespace shake
+
+#endif // BENCHMARKS_HPP
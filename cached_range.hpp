@@ -0,0 +1,192 @@
+#ifndef CACHED_RANGE_HPP
+#define CACHED_RANGE_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <vector>
+
+#include "instrumentation.hpp"
+#include "range.hpp"
+
+namespace shake {
+
+//----------------------------------------------------------------
+// The values of a range that have been computed so far, shared by all iterators over a cached range.
+// Each position is computed at most once, even when multiple threads iterate at the same time:
+// the first thread to reach a position computes it, while others wait for it to become ready.
+template<typename iterator_t>
+class CacheState
+{
+public:
+    using value_t = std::remove_cv_t<typename std::iterator_traits<iterator_t>::value_type>;
+
+private:
+    enum : unsigned char { empty, filling, ready };
+
+public:
+    CacheState
+    (
+        std::size_t n_cached
+    )
+        : m_values  ( n_cached )
+        , m_states  { std::make_unique<std::atomic<unsigned char>[]>( n_cached ) }
+    { }
+
+    std::size_t size() const { return m_values.size(); }
+
+    // Returns the cached value at the position, computing it by dereferencing the iterator if needed.
+    // The position should be smaller than size().
+    const value_t& get( std::size_t position, const iterator_t& it )
+    {
+        auto& state = m_states[ position ];
+        auto current_state = state.load( std::memory_order_acquire );
+        while ( current_state != ready )
+        {
+            if ( current_state == empty && state.compare_exchange_strong( current_state, filling, std::memory_order_acquire ) )
+            {
+                fill( position, it );
+                return *m_values[ position ];
+            }
+            if ( current_state == filling )
+            {
+                state.wait( filling, std::memory_order_acquire );
+            }
+            current_state = state.load( std::memory_order_acquire );
+        }
+        return *m_values[ position ];
+    }
+
+private:
+    void fill( std::size_t position, const iterator_t& it )
+    {
+        auto& state = m_states[ position ];
+        try
+        {
+            m_values[ position ].emplace( *it );
+        }
+        catch ( ... )
+        {
+            // let another attempt compute the value
+            state.store( empty, std::memory_order_release );
+            state.notify_all();
+            throw;
+        }
+        state.store( ready, std::memory_order_release );
+        state.notify_all();
+    }
+
+private:
+    std::vector<std::optional<value_t>>             m_values;
+    std::unique_ptr<std::atomic<unsigned char>[]>   m_states;
+};
+
+//----------------------------------------------------------------
+// Iterates over a range while remembering every value it produces,
+// so that iterating over it again, or from other iterators, does not compute the values again.
+// This pays off for transform ranges with expensive functions that are iterated over multiple times.
+// Only the first positions that fit within the budget are remembered, the others are computed every time.
+template<typename iterator_t>
+class CachedIterator
+{
+public:
+    using state_t = CacheState<iterator_t>;
+
+public:
+    // iterator traits
+    using iterator_category = typename std::iterator_traits<iterator_t>::iterator_category;
+    using value_type        = typename state_t::value_t;
+    using difference_type   = std::ptrdiff_t;
+    using pointer           = const value_type*;
+    using reference         = const value_type&;
+
+public:
+    CachedIterator
+    (
+        std::shared_ptr<state_t>    state,
+        const iterator_t&           iterator,
+        std::size_t                 position
+    )
+        : m_state       { std::move( state ) }
+        , m_iterator    { iterator }
+        , m_position    { position }
+    { }
+
+    const iterator_t& get_internal_iterator() const { return m_iterator; }
+
+    CachedIterator&  operator++()       { SHAKE_COUNT_OPERATION( CachedIterator, "CachedIterator", increments ); ++m_iterator; ++m_position; m_uncached.reset(); return *this; }
+    CachedIterator   operator++(int)    { CachedIterator result = *this; ++(*this); return result; }
+
+    // Only available when the internal iterator supports them, like its iterator_category says.
+    // Jumping ahead does not compute any of the skipped values.
+    CachedIterator&     operator--()                        { --m_iterator; --m_position; m_uncached.reset(); return *this; }
+    CachedIterator&     operator+=(difference_type n)       { m_iterator += n; m_position += n; m_uncached.reset(); return *this; }
+    CachedIterator&     operator-=(difference_type n)       { return *this += -n; }
+    CachedIterator      operator+ (difference_type n) const { CachedIterator result = *this; return result += n; }
+    CachedIterator      operator- (difference_type n) const { CachedIterator result = *this; return result -= n; }
+    difference_type     operator- (const CachedIterator& other) const { return static_cast<difference_type>( m_position - other.m_position ); }
+
+    bool operator==(const CachedIterator& other) const { SHAKE_COUNT_OPERATION( CachedIterator, "CachedIterator", comparisons ); return m_position == other.m_position; }
+    bool operator!=(const CachedIterator& other) const { return !(*this == other); }
+    bool operator< (const CachedIterator& other) const { return m_position < other.m_position; }
+
+    // The reference stays valid for as long as the range exists,
+    // except for positions beyond the budget, for which it is valid until this iterator moves.
+    const value_type& operator*() const
+    {
+        SHAKE_COUNT_OPERATION( CachedIterator, "CachedIterator", dereferences );
+        if ( m_position < m_state->size() )
+        {
+            return m_state->get( m_position, m_iterator );
+        }
+        if ( !m_uncached )
+        {
+            m_uncached.emplace( *m_iterator );
+        }
+        return *m_uncached;
+    }
+
+private:
+    std::shared_ptr<state_t>            m_state;
+    iterator_t                          m_iterator;
+    std::size_t                         m_position;
+    mutable std::optional<value_type>   m_uncached;
+    SHAKE_COUNT_COPIES( CachedIterator, "CachedIterator" );
+};
+
+//----------------------------------------------------------------
+template<typename iterator_t>
+using CachedRange = Range<CachedIterator<iterator_t>>;
+
+//----------------------------------------------------------------
+// At most max_cached_elements values are kept in memory, for the first positions of the range.
+// The memory for them is allocated up front, but the values are only computed when they are first dereferenced.
+template<typename range_t>
+CachedRange<typename range_t::iterator> cached
+(
+    range_t         input_range,
+    std::size_t     max_cached_elements = std::numeric_limits<std::size_t>::max()
+)
+{
+    using iterator_t = typename range_t::iterator;
+
+    const auto begin_iterator   = std::begin( input_range );
+    const auto end_iterator     = std::end( input_range );
+    const auto size             = static_cast<std::size_t>( std::distance( begin_iterator, end_iterator ) );
+    const auto state            = std::make_shared<CacheState<iterator_t>>( std::min( size, max_cached_elements ) );
+
+    return Range
+    {
+        CachedIterator<iterator_t> { state, begin_iterator, 0    },
+        CachedIterator<iterator_t> { state, end_iterator,   size }
+    };
+}
+
+} // namespace shake
+
+#endif // CACHED_RANGE_HPP
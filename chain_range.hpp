@@ -0,0 +1,272 @@
+#ifndef CHAIN_RANGE_HPP
+#define CHAIN_RANGE_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <iterator>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "instrumentation.hpp"
+#include "range.hpp"
+
+namespace shake {
+
+//----------------------------------------------------------------
+// Iterates over multiple ranges back to back, which are called the segments of the chain.
+// The segments may have different iterator types, as long as their elements have a common reference type.
+// Every increment checks whether the current segment has ended, so the algorithms in algorithm.hpp and collect.hpp
+// iterate over the segments themselves instead, each with a tight loop of its own.
+template<typename... IteratorArgs>
+class ChainIterator
+{
+    static_assert( sizeof...( IteratorArgs ) > 0, "a chain needs at least one range" );
+
+public:
+    using tuple_t = std::tuple<IteratorArgs...>;
+
+    static constexpr std::size_t n_segments = sizeof...( IteratorArgs );
+
+public:
+    // iterator traits
+    using iterator_category = std::forward_iterator_tag;
+    using reference         = std::common_reference_t<typename std::iterator_traits<IteratorArgs>::reference ...>;
+    using value_type        = std::remove_cvref_t<reference>;
+    using difference_type   = std::ptrdiff_t;
+    using pointer           = std::add_pointer_t<reference>;
+
+public:
+    // Starts in the segment, or in the first non-empty segment after it
+    ChainIterator
+    (
+        const tuple_t&  iterators,
+        const tuple_t&  end_iterators,
+        std::size_t     segment
+    )
+        : m_iterators       { iterators }
+        , m_end_iterators   { end_iterators }
+        , m_segment         { segment }
+    {
+        skip_empty_segments<0>();
+    }
+
+    const tuple_t&  get_internal_iterator() const { return m_iterators; }
+    const tuple_t&  get_end_iterators()     const { return m_end_iterators; }
+    std::size_t     get_segment()           const { return m_segment; }
+
+    ChainIterator& operator++()
+    {
+        SHAKE_COUNT_OPERATION( ChainIterator, "ChainIterator", increments );
+        visit( [ this ]( auto segment )
+        {
+            if ( ++std::get<segment>( m_iterators ) == std::get<segment>( m_end_iterators ) )
+            {
+                ++m_segment;
+                skip_empty_segments<segment + 1>();
+            }
+        } );
+        return *this;
+    }
+
+    ChainIterator operator++(int) { ChainIterator result = *this; ++(*this); return result; }
+
+    bool operator==(const ChainIterator& other) const
+    {
+        SHAKE_COUNT_OPERATION( ChainIterator, "ChainIterator", comparisons );
+        if ( m_segment != other.m_segment )
+        {
+            return false;
+        }
+        auto is_equal = true;
+        visit( [ & ]( auto segment ) { is_equal = std::get<segment>( m_iterators ) == std::get<segment>( other.m_iterators ); } );
+        return is_equal;
+    }
+
+    bool operator!=(const ChainIterator& other) const { return !(*this == other); }
+
+    reference operator*() const
+    {
+        SHAKE_COUNT_OPERATION( ChainIterator, "ChainIterator", dereferences );
+        return dereference<0>();
+    }
+
+private:
+    // Calls the function with the index of the current segment as a compile-time constant, unless the chain has ended
+    template<typename function_t, std::size_t segment = 0>
+    void visit( function_t&& function ) const
+    {
+        if constexpr ( segment < n_segments )
+        {
+            if ( m_segment == segment )
+            {
+                function( std::integral_constant<std::size_t, segment> { } );
+            }
+            else
+            {
+                visit<function_t, segment + 1>( std::forward<function_t>( function ) );
+            }
+        }
+    }
+
+    template<std::size_t segment>
+    reference dereference() const
+    {
+        if constexpr ( segment + 1 < n_segments )
+        {
+            if ( m_segment != segment )
+            {
+                return dereference<segment + 1>();
+            }
+        }
+        return *std::get<segment>( m_iterators );
+    }
+
+    // Moves on from the current segment while it is empty, where the segment is at least first_segment
+    template<std::size_t first_segment>
+    void skip_empty_segments()
+    {
+        if constexpr ( first_segment < n_segments )
+        {
+            if ( m_segment == first_segment )
+            {
+                if ( std::get<first_segment>( m_iterators ) != std::get<first_segment>( m_end_iterators ) )
+                {
+                    return;
+                }
+                ++m_segment;
+            }
+            skip_empty_segments<first_segment + 1>();
+        }
+    }
+
+private:
+    tuple_t         m_iterators;
+    tuple_t         m_end_iterators;
+    std::size_t     m_segment;
+    SHAKE_COUNT_COPIES( ChainIterator, "ChainIterator" );
+};
+
+//----------------------------------------------------------------
+template<typename... IteratorArgs>
+using ChainRange = Range<ChainIterator<IteratorArgs...>>;
+
+//----------------------------------------------------------------
+template<typename T>
+struct is_chain_iterator : std::false_type { };
+
+template<typename... IteratorArgs>
+struct is_chain_iterator<ChainIterator<IteratorArgs...>> : std::true_type { };
+
+template<typename T>
+inline constexpr bool is_chain_iterator_v = is_chain_iterator<T>::value;
+
+//----------------------------------------------------------------
+// Iterates over the ranges back to back, like itertools.chain.
+template<typename... RangeArgs>
+ChainRange<typename RangeArgs::iterator...> chain
+(
+    RangeArgs... range_args
+)
+{
+    using iterator_t = ChainIterator<typename RangeArgs::iterator...>;
+
+    const auto begin_iterators  = std::make_tuple( std::begin( range_args ) ... );
+    const auto end_iterators    = std::make_tuple( std::end( range_args ) ... );
+
+    return Range
+    {
+        iterator_t { begin_iterators, end_iterators, 0                      },
+        iterator_t { end_iterators,   end_iterators, iterator_t::n_segments }
+    };
+}
+
+//----------------------------------------------------------------
+// The parts of the segments of a chain between its begin and end, as a tuple of ranges.
+// The chain can be a part of a longer chain, like a window or a group of it, so each segment is clipped by both ends:
+// the segments before the one the chain begins in, and those after the one it ends in, are empty.
+template<typename... IteratorArgs>
+auto segments
+(
+    const ChainRange<IteratorArgs...>& chain_range
+)
+{
+    const auto begin_iterator   = chain_range.begin();
+    const auto end_iterator     = chain_range.end();
+    const auto segment_range    = [ & ]( auto segment )
+    {
+        const auto& segment_end = std::get<segment>( begin_iterator.get_end_iterators() );
+        const auto begin = segment < begin_iterator.get_segment() ? segment_end : std::get<segment>( begin_iterator.get_internal_iterator() );
+        const auto end =
+            segment < end_iterator.get_segment()    ? segment_end :
+            segment == end_iterator.get_segment()   ? std::get<segment>( end_iterator.get_internal_iterator() ) :
+                                                      begin;
+        return Range { begin, end };
+    };
+    return [ & ]<std::size_t... segment_indices>( std::index_sequence<segment_indices...> )
+    {
+        return std::make_tuple( segment_range( std::integral_constant<std::size_t, segment_indices> { } ) ... );
+    }( std::index_sequence_for<IteratorArgs...> { } );
+}
+
+//----------------------------------------------------------------
+// Returns one of n_parts consecutive parts of a chain of random-access ranges, with sizes that differ by at most one element.
+// Each part is a chain of the overlapping parts of the segments, so it can still be iterated over segment by segment.
+template<typename... IteratorArgs>
+ChainRange<IteratorArgs...> split
+(
+    const ChainRange<IteratorArgs...>&  chain_range,
+    std::size_t                         n_parts,
+    std::size_t                         part
+)
+{
+    static_assert
+    (
+        ( std::is_base_of_v<std::random_access_iterator_tag, typename std::iterator_traits<IteratorArgs>::iterator_category> && ... ),
+        "only chains of random-access ranges can be split"
+    );
+    using iterator_t = ChainIterator<IteratorArgs...>;
+
+    const auto all_segments = segments( chain_range );
+    const auto sizes = std::apply
+    (
+        []( const auto&... segment ) { return std::array<std::size_t, iterator_t::n_segments> { static_cast<std::size_t>( segment.end() - segment.begin() ) ... }; },
+        all_segments
+    );
+    auto size = std::size_t { 0 };
+    for ( const auto segment_size : sizes )
+    {
+        size += segment_size;
+    }
+
+    // like the split of a single range, the first size % n_parts parts get one extra element
+    const auto part_begin = [ & ]( std::size_t p ) { return p * ( size / n_parts ) + ( p < size % n_parts ? p : size % n_parts ); };
+    const auto begin_offset = part_begin( part );
+    const auto end_offset   = part_begin( part + 1 );
+
+    // clip each segment to the part, relative to the offset of the segment in the whole chain
+    return [ & ]<std::size_t... segment_indices>( std::index_sequence<segment_indices...> )
+    {
+        auto segment_offsets = std::array<std::size_t, iterator_t::n_segments> { };
+        for ( std::size_t i = 1; i < iterator_t::n_segments; ++i )
+        {
+            segment_offsets[ i ] = segment_offsets[ i - 1 ] + sizes[ i - 1 ];
+        }
+        const auto clip = [ & ]( std::size_t segment, std::size_t offset )
+        {
+            return static_cast<std::ptrdiff_t>( std::min( std::max( offset, segment_offsets[ segment ] ) - segment_offsets[ segment ], sizes[ segment ] ) );
+        };
+        const auto begin_iterators  = std::make_tuple( std::get<segment_indices>( all_segments ).begin() + clip( segment_indices, begin_offset ) ... );
+        const auto end_iterators    = std::make_tuple( std::get<segment_indices>( all_segments ).begin() + clip( segment_indices, end_offset ) ... );
+        return Range
+        {
+            iterator_t { begin_iterators, end_iterators, 0                      },
+            iterator_t { end_iterators,   end_iterators, iterator_t::n_segments }
+        };
+    }( std::index_sequence_for<IteratorArgs...> { } );
+}
+
+} // namespace shake
+
+#endif // CHAIN_RANGE_HPP
@@ -0,0 +1,266 @@
+#ifndef CHUNK_RANGE_HPP
+#define CHUNK_RANGE_HPP
+
+#include <bit>
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#ifdef __SSE2__
+    #include <emmintrin.h>
+#endif
+
+#include "instrumentation.hpp"
+#include "range.hpp"
+
+namespace shake {
+
+namespace chunk_detail {
+
+//----------------------------------------------------------------
+// Returns the first element from first on that differs from the value, or last.
+// Elements that are equal exactly when their bytes are equal, like integers, are compared 16 bytes at a time with SSE2.
+template<typename value_t>
+const value_t* find_first_not_equal( const value_t* first, const value_t* last, const value_t& value )
+{
+#ifdef __SSE2__
+    if constexpr ( std::has_unique_object_representations_v<value_t> && 16 % sizeof( value_t ) == 0 )
+    {
+        constexpr auto n_per_block = static_cast<std::ptrdiff_t>( 16 / sizeof( value_t ) );
+
+        unsigned char pattern_bytes[ 16 ];
+        for ( std::ptrdiff_t i = 0; i < n_per_block; ++i )
+        {
+            std::memcpy( pattern_bytes + i * sizeof( value_t ), std::addressof( value ), sizeof( value_t ) );
+        }
+        const auto pattern = _mm_loadu_si128( reinterpret_cast<const __m128i*>( pattern_bytes ) );
+        for ( ; last - first >= n_per_block; first += n_per_block )
+        {
+            const auto block = _mm_loadu_si128( reinterpret_cast<const __m128i*>( first ) );
+            // a bit per byte, which is set when the byte is equal to that of the pattern
+            const auto equal_bytes = static_cast<unsigned int>( _mm_movemask_epi8( _mm_cmpeq_epi8( block, pattern ) ) );
+            if ( equal_bytes != 0xFFFF )
+            {
+                return first + std::countr_one( equal_bytes ) / sizeof( value_t );
+            }
+        }
+    }
+#endif
+    for ( ; first != last && *first == value; ++first ) { }
+    return first;
+}
+
+//----------------------------------------------------------------
+// Groups are either made of consecutive elements with equal keys, or of consecutive elements for which
+// a predicate holds for every pair of neighbours, depending on whether the function takes one or two elements.
+template<typename function_t, typename reference_t>
+inline constexpr bool is_predicate_v = std::is_invocable_v<const function_t&, reference_t, reference_t>;
+
+// Returns the end of the group that starts at begin, which should not be the end.
+// Like the standard algorithms, it takes the function by value.
+template<typename iterator_t, typename function_t>
+iterator_t find_group_end( const iterator_t& begin, const iterator_t& end, function_t function )
+{
+    using reference_t = typename std::iterator_traits<iterator_t>::reference;
+
+    if constexpr ( is_predicate_v<function_t, reference_t> )
+    {
+        auto previous = begin;
+        auto it = std::next( begin );
+        for ( ; it != end && std::invoke( function, *previous, *it ); ++previous, ++it ) { }
+        return it;
+    }
+    else if constexpr ( std::is_same_v<function_t, std::identity> && std::contiguous_iterator<iterator_t> )
+    {
+        const auto* first = std::to_address( begin );
+        return begin + ( find_first_not_equal( first + 1, std::to_address( end ), *first ) - first );
+    }
+    else
+    {
+        const auto key = std::invoke( function, *begin );
+        auto it = std::next( begin );
+        for ( ; it != end && std::invoke( function, *it ) == key; ++it ) { }
+        return it;
+    }
+}
+
+// The key of a group is the result of the key function, or the first element of the group for a predicate
+template<typename iterator_t, typename function_t, bool = is_predicate_v<function_t, typename std::iterator_traits<iterator_t>::reference>>
+struct key
+{
+    using type = std::remove_cvref_t<std::invoke_result_t<const function_t&, typename std::iterator_traits<iterator_t>::reference>>;
+};
+
+template<typename iterator_t, typename function_t>
+struct key<iterator_t, function_t, true>
+{
+    using type = typename std::iterator_traits<iterator_t>::value_type;
+};
+
+} // namespace chunk_detail
+
+//----------------------------------------------------------------
+// Iterates over the groups of consecutive elements of a range that belong together,
+// and exposes each group as a pair of its key and a range over its elements, without copying them.
+// With a predicate instead of a key function, the key of a group is its first element.
+// The end of a group is found when moving to it, so every element is compared once.
+template<typename iterator_t, typename function_t>
+class ChunkIterator
+{
+public:
+    using key_t = typename chunk_detail::key<iterator_t, function_t>::type;
+
+public:
+    // iterator traits
+    using iterator_category = std::forward_iterator_tag;
+    using value_type        = std::pair<key_t, Range<iterator_t>>;
+    using difference_type   = std::ptrdiff_t;
+    using pointer           = value_type*;
+    using reference         = value_type;
+
+public:
+    // Starts at the group that begins at the iterator
+    ChunkIterator
+    (
+        const iterator_t&   iterator,
+        const iterator_t&   end_iterator,
+        const function_t&   function
+    )
+        : m_iterator        { iterator }
+        , m_group_end       { iterator }
+        , m_end_iterator    { end_iterator }
+        , m_function        { function }
+    {
+        find_group_end();
+    }
+
+    const iterator_t& get_internal_iterator() const { return m_iterator; }
+    const function_t& get_function()          const { return m_function; }
+
+    ChunkIterator& operator++()
+    {
+        SHAKE_COUNT_OPERATION( ChunkIterator, "ChunkIterator", increments );
+        m_iterator = m_group_end;
+        find_group_end();
+        return *this;
+    }
+
+    ChunkIterator operator++(int) { ChunkIterator result = *this; ++(*this); return result; }
+
+    bool operator==(const ChunkIterator& other) const { SHAKE_COUNT_OPERATION( ChunkIterator, "ChunkIterator", comparisons ); return m_iterator == other.m_iterator; }
+    bool operator!=(const ChunkIterator& other) const { return !(*this == other); }
+
+    value_type operator*() const
+    {
+        SHAKE_COUNT_OPERATION( ChunkIterator, "ChunkIterator", dereferences );
+        return value_type { key(), Range { m_iterator, m_group_end } };
+    }
+
+private:
+    key_t key() const
+    {
+        if constexpr ( chunk_detail::is_predicate_v<function_t, typename std::iterator_traits<iterator_t>::reference> )
+        {
+            return *m_iterator;
+        }
+        else
+        {
+            return std::invoke( m_function, *m_iterator );
+        }
+    }
+
+    void find_group_end()
+    {
+        if ( m_iterator != m_end_iterator )
+        {
+            m_group_end = chunk_detail::find_group_end( m_iterator, m_end_iterator, m_function );
+        }
+    }
+
+private:
+    iterator_t  m_iterator;
+    iterator_t  m_group_end;
+    iterator_t  m_end_iterator;
+    function_t  m_function;
+    SHAKE_COUNT_COPIES( ChunkIterator, "ChunkIterator" );
+};
+
+//----------------------------------------------------------------
+template<typename iterator_t, typename function_t>
+using ChunkRange = Range<ChunkIterator<iterator_t, function_t>>;
+
+//----------------------------------------------------------------
+// Iterates over the groups of consecutive elements with the same key, like itertools.groupby,
+// or of consecutive elements for which the predicate holds for each pair of neighbours.
+// Without a key function, groups are runs of equal elements, which are found with SIMD on contiguous ranges of integers.
+template<typename range_t, typename function_t = std::identity>
+ChunkRange<typename range_t::iterator, function_t> chunk_by
+(
+    range_t     input_range,
+    function_t  key_or_predicate = { }
+)
+{
+    using iterator_t = ChunkIterator<typename range_t::iterator, function_t>;
+
+    const auto begin_iterator   = std::begin( input_range );
+    const auto end_iterator     = std::end( input_range );
+
+    return Range
+    {
+        iterator_t { begin_iterator, end_iterator, key_or_predicate },
+        iterator_t { end_iterator,   end_iterator, key_or_predicate }
+    };
+}
+
+//----------------------------------------------------------------
+// Returns one of n_parts consecutive parts of the groups of a random-access range, with about the same number of elements,
+// e.g. to process the groups on multiple threads. Parts only begin at the beginning of a group, so no group is split,
+// which means that parts can be empty, and that a part can be much larger than the others when a group is.
+template<typename iterator_t, typename function_t>
+ChunkRange<iterator_t, function_t> split
+(
+    const ChunkRange<iterator_t, function_t>&   chunk_range,
+    std::size_t                                 n_parts,
+    std::size_t                                 part
+)
+{
+    using chunk_iterator_t = ChunkIterator<iterator_t, function_t>;
+
+    static_assert
+    (
+        std::is_base_of_v<std::random_access_iterator_tag, typename std::iterator_traits<iterator_t>::iterator_category>,
+        "only groups of random-access ranges can be split"
+    );
+
+    const auto begin_iterator   = chunk_range.begin().get_internal_iterator();
+    const auto end_iterator     = chunk_range.end().get_internal_iterator();
+    const auto& function        = chunk_range.begin().get_function();
+
+    // moves a boundary between elements forward to the next boundary between groups
+    const auto group_boundary = [ & ]( std::size_t n_parts_before )
+    {
+        const auto boundary = split( Range { begin_iterator, end_iterator }, n_parts, n_parts_before ).begin();
+        if ( boundary == begin_iterator || boundary == end_iterator )
+        {
+            return boundary;
+        }
+        const auto previous = std::prev( boundary );
+        return chunk_detail::find_group_end( previous, end_iterator, function );
+    };
+    const auto part_begin   = group_boundary( part );
+    const auto part_end     = part + 1 == n_parts ? end_iterator : group_boundary( part + 1 );
+
+    return Range
+    {
+        chunk_iterator_t { part_begin,  part_end, function },
+        chunk_iterator_t { part_end,    part_end, function }
+    };
+}
+
+} // namespace shake
+
+#endif // CHUNK_RANGE_HPP
@@ -0,0 +1,232 @@
+#ifndef COLLECT_HPP
+#define COLLECT_HPP
+
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <ranges>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "chain_range.hpp"
+#include "flatten_range.hpp"
+#include "range.hpp"
+
+namespace shake {
+
+namespace collect_detail {
+
+//----------------------------------------------------------------
+template<typename range_t>
+using iterator_t = decltype( std::begin( std::declval<range_t&>() ) );
+
+// Collected elements own their values, so tuples of references (as produced by combine) are collected as tuples of values
+template<typename T>
+struct owning_value
+{
+    using type = std::remove_cv_t<T>;
+};
+
+template<typename... Ts>
+struct owning_value<std::tuple<Ts...>>
+{
+    using type = std::tuple<std::remove_cvref_t<Ts>...>;
+};
+
+template<typename range_t>
+using value_t = typename owning_value<typename std::iterator_traits<iterator_t<range_t>>::value_type>::type;
+
+// The number of elements is known up front when the distance between begin and end can be computed directly
+template<typename iterator_t>
+inline constexpr bool is_sized_v = std::is_base_of_v
+<
+    std::random_access_iterator_tag,
+    typename std::iterator_traits<iterator_t>::iterator_category
+>;
+
+// Elements can be copied as raw bytes when they lie back to back in memory, and have no copy semantics of their own
+template<typename iterator_t, typename value_t>
+inline constexpr bool is_memcpy_compatible_v =
+    std::contiguous_iterator<iterator_t>
+    && std::is_trivially_copyable_v<value_t>
+    && std::is_same_v<std::remove_cv_t<std::iter_value_t<iterator_t>>, value_t>;
+
+// Elements can be moved out of an rvalue container that owns them, but not out of an rvalue range or borrowed view,
+// like std::span or std::string_view, which only refers to elements owned by someone else
+template<typename range_t>
+inline constexpr bool is_movable_source_v =
+    !std::is_lvalue_reference_v<range_t>
+    && !is_range_v<std::remove_cvref_t<range_t>>
+    && !std::ranges::borrowed_range<range_t>;
+
+template<typename container_t, typename = void>
+struct has_reserve : std::false_type { };
+
+template<typename container_t>
+struct has_reserve<container_t, std::void_t<decltype( std::declval<container_t&>().reserve( std::size_t { } ) )>> : std::true_type { };
+
+//----------------------------------------------------------------
+// Appends all elements of the range to the back of the container,
+// with at most a single allocation when the size of the range is known.
+// Chained and flattened ranges are appended segment by segment, so each segment can take the fastest path for its own iterator type.
+template<typename container_t, typename range_t>
+void append( container_t& container, range_t&& input_range )
+{
+    using source_iterator_t = iterator_t<range_t>;
+
+    if constexpr ( is_chain_iterator_v<source_iterator_t> )
+    {
+        std::apply( [ & ]( const auto&... segment )
+        {
+            if constexpr ( ( is_sized_v<iterator_t<decltype( segment )>> && ... ) && has_reserve<container_t>::value )
+            {
+                container.reserve( container.size() + ( static_cast<std::size_t>( segment.end() - segment.begin() ) + ... ) );
+            }
+            ( append( container, segment ), ... );
+        }, segments( input_range ) );
+        return;
+    }
+    else if constexpr ( is_flatten_iterator_v<source_iterator_t> )
+    {
+        if constexpr ( is_sized_v<typename source_iterator_t::inner_iterator_t> && has_reserve<container_t>::value )
+        {
+            container.reserve( container.size() + flat_size( input_range ) );
+        }
+        for_each_segment( input_range, [ & ]( const auto& segment ) { append( container, segment ); } );
+        return;
+    }
+
+    auto it = std::begin( input_range );
+    const auto end = std::end( input_range );
+
+    if constexpr ( is_sized_v<source_iterator_t> && has_reserve<container_t>::value )
+    {
+        container.reserve( container.size() + static_cast<std::size_t>( end - it ) );
+    }
+
+    if constexpr
+    (
+        is_memcpy_compatible_v<source_iterator_t, typename container_t::value_type>
+        && std::contiguous_iterator<typename container_t::iterator>
+    )
+    {
+        // Inserting a range of pointers to trivially copyable elements is done by the standard library with a single memmove
+        container.insert( std::end( container ), std::to_address( it ), std::to_address( it ) + ( end - it ) );
+    }
+    else
+    {
+        for ( ; it != end; ++it )
+        {
+            if constexpr ( is_movable_source_v<range_t> )
+            {
+                container.insert( std::end( container ), std::move( *it ) );
+            }
+            else
+            {
+                container.insert( std::end( container ), *it );
+            }
+        }
+    }
+}
+
+} // namespace collect_detail
+
+//----------------------------------------------------------------
+// Collects all elements of a range, or container, into a new container.
+// Any container with an insert( position, value ) member can be used, like std::vector, std::deque, std::set or std::map.
+// Elements are moved instead of copied when the input is an rvalue container.
+template<typename container_t, typename range_t>
+container_t collect
+(
+    range_t&& input_range
+)
+{
+    auto container = container_t { };
+    collect_detail::append( container, std::forward<range_t>( input_range ) );
+    return container;
+}
+
+//----------------------------------------------------------------
+// Collects all elements of a range, or container, into a new std::vector.
+// An rvalue std::vector of the same type is returned as it is, without copying or moving any element.
+template<typename range_t>
+auto to_vector
+(
+    range_t&& input_range
+)
+{
+    using vector_t = std::vector<collect_detail::value_t<range_t>>;
+
+    if constexpr ( collect_detail::is_movable_source_v<range_t> && std::is_same_v<std::remove_cvref_t<range_t>, vector_t> )
+    {
+        return vector_t { std::move( input_range ) };
+    }
+    else
+    {
+        return collect<vector_t>( std::forward<range_t>( input_range ) );
+    }
+}
+
+//----------------------------------------------------------------
+// Copies all elements of a range, or container, to an output iterator, and returns the advanced output iterator.
+// Contiguous trivially copyable elements are copied with a single memcpy when the output is contiguous too,
+// and elements are moved instead of copied when the input is an rvalue container.
+// Chained and flattened ranges are copied segment by segment, so a contiguous segment is copied with a memcpy of its own.
+template<typename range_t, typename output_iterator_t>
+output_iterator_t copy_into
+(
+    range_t&&           input_range,
+    output_iterator_t   output
+)
+{
+    using source_iterator_t = collect_detail::iterator_t<range_t>;
+
+    if constexpr ( is_chain_iterator_v<source_iterator_t> )
+    {
+        std::apply( [ & ]( const auto&... segment ) { ( ( output = copy_into( segment, output ) ), ... ); }, segments( input_range ) );
+        return output;
+    }
+    else if constexpr ( is_flatten_iterator_v<source_iterator_t> )
+    {
+        for_each_segment( input_range, [ & ]( const auto& segment ) { output = copy_into( segment, output ); } );
+        return output;
+    }
+
+    auto it = std::begin( input_range );
+    const auto end = std::end( input_range );
+
+    if constexpr
+    (
+        collect_detail::is_memcpy_compatible_v<source_iterator_t, collect_detail::value_t<range_t>>
+        && collect_detail::is_memcpy_compatible_v<output_iterator_t, collect_detail::value_t<range_t>>
+    )
+    {
+        const auto n = end - it;
+        if ( n > 0 )
+        {
+            std::memcpy( std::to_address( output ), std::to_address( it ), static_cast<std::size_t>( n ) * sizeof( *std::to_address( it ) ) );
+        }
+        return output + n;
+    }
+    else
+    {
+        for ( ; it != end; ++it, ++output )
+        {
+            if constexpr ( collect_detail::is_movable_source_v<range_t> )
+            {
+                *output = std::move( *it );
+            }
+            else
+            {
+                *output = *it;
+            }
+        }
+        return output;
+    }
+}
+
+} // namespace shake
+
+#endif // COLLECT_HPP
@@ -0,0 +1,380 @@
+#ifndef COMBINATORICS_RANGE_HPP
+#define COMBINATORICS_RANGE_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <numeric>
+#include <type_traits>
+#include <vector>
+
+#include "instrumentation.hpp"
+#include "range.hpp"
+
+namespace shake {
+
+//----------------------------------------------------------------
+// Iterates over the elements of a random-access range at a sequence of indices, without copying the elements.
+template<typename iterator_t>
+class IndirectIterator
+{
+public:
+    // iterator traits
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type        = typename std::iterator_traits<iterator_t>::value_type;
+    using difference_type   = std::ptrdiff_t;
+    using pointer           = typename std::iterator_traits<iterator_t>::pointer;
+    using reference         = decltype( std::declval<const iterator_t&>()[ 0 ] );
+
+public:
+    IndirectIterator
+    (
+        const iterator_t&       begin_iterator,
+        const std::size_t*      index
+    )
+        : m_begin_iterator  { begin_iterator }
+        , m_index           { index }
+    { }
+
+    const std::size_t* get_internal_index() const { return m_index; }
+
+    IndirectIterator&   operator++()                        { SHAKE_COUNT_OPERATION( IndirectIterator, "IndirectIterator", increments ); ++m_index; return *this; }
+    IndirectIterator    operator++(int)                     { IndirectIterator result = *this; ++(*this); return result; }
+    IndirectIterator&   operator--()                        { --m_index; return *this; }
+    IndirectIterator    operator--(int)                     { IndirectIterator result = *this; --(*this); return result; }
+    IndirectIterator&   operator+=(difference_type n)       { m_index += n; return *this; }
+    IndirectIterator&   operator-=(difference_type n)       { m_index -= n; return *this; }
+    IndirectIterator    operator+ (difference_type n) const { IndirectIterator result = *this; return result += n; }
+    IndirectIterator    operator- (difference_type n) const { IndirectIterator result = *this; return result -= n; }
+    difference_type     operator- (const IndirectIterator& other) const { return m_index - other.m_index; }
+
+    bool operator==(const IndirectIterator& other) const { SHAKE_COUNT_OPERATION( IndirectIterator, "IndirectIterator", comparisons ); return m_index == other.m_index; }
+    bool operator!=(const IndirectIterator& other) const { return !(*this == other); }
+    bool operator< (const IndirectIterator& other) const { return m_index < other.m_index; }
+
+    reference operator*() const
+    {
+        SHAKE_COUNT_OPERATION( IndirectIterator, "IndirectIterator", dereferences );
+        return m_begin_iterator[ static_cast<difference_type>( *m_index ) ];
+    }
+
+    reference operator[](difference_type n) const { return *( *this + n ); }
+
+private:
+    iterator_t          m_begin_iterator;
+    const std::size_t*  m_index;
+    SHAKE_COUNT_COPIES( IndirectIterator, "IndirectIterator" );
+};
+
+//----------------------------------------------------------------
+template<typename iterator_t>
+using IndirectRange = Range<IndirectIterator<iterator_t>>;
+
+namespace combinatorics_detail {
+
+//----------------------------------------------------------------
+// The number of ways to choose k out of n elements, which should fit in 64 bits
+inline std::uint64_t binomial( std::uint64_t n, std::uint64_t k )
+{
+    if ( k > n )
+    {
+        return 0;
+    }
+    k = std::min( k, n - k );
+    auto result = std::uint64_t { 1 };
+    for ( std::uint64_t i = 1; i <= k; ++i )
+    {
+        // After this step, the result is binomial( n - k + i, i ), which is the previous result times ( n - k + i ) / i.
+        // That product is divisible by i, but it can overflow even when the result fits, e.g. for n >= 63,
+        // so the common factor of the result and i is divided out first, after which the rest of i divides ( n - k + i ).
+        const auto common   = std::gcd( result, i );
+        result = ( result / common ) * ( ( n - k + i ) / ( i / common ) );
+    }
+    return result;
+}
+
+inline std::uint64_t factorial( std::uint64_t n )
+{
+    auto result = std::uint64_t { 1 };
+    for ( std::uint64_t i = 2; i <= n; ++i )
+    {
+        result *= i;
+    }
+    return result;
+}
+
+} // namespace combinatorics_detail
+
+//----------------------------------------------------------------
+// Iterates over the subsets of k elements of a random-access range, in lexicographic order of their indices.
+// Each subset is a view on the elements of the range through the indices inside the iterator,
+// so no memory is allocated per subset, but the view is only valid until the iterator moves.
+// Jumping to a rank unranks it with the combinatorial number system, so the range is random-access by rank,
+// and the search space can be split evenly with split, or entered at a rank with nth.
+template<typename iterator_t>
+class CombinationIterator
+{
+public:
+    // iterator traits
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type        = IndirectRange<iterator_t>;
+    using difference_type   = std::ptrdiff_t;
+    using pointer           = value_type*;
+    using reference         = value_type&;
+
+public:
+    CombinationIterator
+    (
+        const iterator_t&   begin_iterator,
+        std::size_t         n_elements,
+        std::size_t         k,
+        std::uint64_t       rank
+    )
+        : m_begin_iterator  { begin_iterator }
+        , m_n_elements      { n_elements }
+        , m_n_combinations  { combinatorics_detail::binomial( n_elements, k ) }
+        , m_indices         ( k )
+    {
+        move_to( rank );
+    }
+
+    const std::vector<std::size_t>& get_internal_indices() const { return m_indices; }
+    std::uint64_t get_rank() const { return m_rank; }
+
+    CombinationIterator& operator++()
+    {
+        SHAKE_COUNT_OPERATION( CombinationIterator, "CombinationIterator", increments );
+        if ( ++m_rank == m_n_combinations )
+        {
+            return *this;
+        }
+        // increment the last index that can still move right, and put the ones after it right behind it
+        const auto k = m_indices.size();
+        auto i = k - 1;
+        while ( m_indices[ i ] == m_n_elements - k + i )
+        {
+            --i;
+        }
+        ++m_indices[ i ];
+        for ( auto j = i + 1; j < k; ++j )
+        {
+            m_indices[ j ] = m_indices[ j - 1 ] + 1;
+        }
+        return *this;
+    }
+
+    CombinationIterator operator++(int) { CombinationIterator result = *this; ++(*this); return result; }
+
+    CombinationIterator&    operator--()                        { move_to( m_rank - 1 ); return *this; }
+    CombinationIterator&    operator+=(difference_type n)       { move_to( m_rank + static_cast<std::uint64_t>( n ) ); return *this; }
+    CombinationIterator&    operator-=(difference_type n)       { return *this += -n; }
+    CombinationIterator     operator+ (difference_type n) const { CombinationIterator result = *this; return result += n; }
+    CombinationIterator     operator- (difference_type n) const { CombinationIterator result = *this; return result -= n; }
+    difference_type         operator- (const CombinationIterator& other) const { return static_cast<difference_type>( m_rank - other.m_rank ); }
+
+    bool operator==(const CombinationIterator& other) const { SHAKE_COUNT_OPERATION( CombinationIterator, "CombinationIterator", comparisons ); return m_rank == other.m_rank; }
+    bool operator!=(const CombinationIterator& other) const { return !(*this == other); }
+    bool operator< (const CombinationIterator& other) const { return m_rank < other.m_rank; }
+
+    value_type operator*() const
+    {
+        SHAKE_COUNT_OPERATION( CombinationIterator, "CombinationIterator", dereferences );
+        return Range
+        {
+            IndirectIterator<iterator_t> { m_begin_iterator, m_indices.data() },
+            IndirectIterator<iterator_t> { m_begin_iterator, m_indices.data() + m_indices.size() }
+        };
+    }
+
+private:
+    // Chooses each index in turn, skipping the values for which fewer subsets start with it than the remaining rank
+    void move_to( std::uint64_t rank )
+    {
+        m_rank = rank;
+        if ( rank >= m_n_combinations )
+        {
+            return;
+        }
+        const auto k = m_indices.size();
+        auto value = std::size_t { 0 };
+        for ( std::size_t i = 0; i < k; ++i, ++value )
+        {
+            for ( ;; ++value )
+            {
+                const auto n_starting_with_value = combinatorics_detail::binomial( m_n_elements - value - 1, k - i - 1 );
+                if ( rank < n_starting_with_value )
+                {
+                    break;
+                }
+                rank -= n_starting_with_value;
+            }
+            m_indices[ i ] = value;
+        }
+    }
+
+private:
+    iterator_t                  m_begin_iterator;
+    std::size_t                 m_n_elements;
+    std::uint64_t               m_n_combinations;
+    std::uint64_t               m_rank;
+    std::vector<std::size_t>    m_indices;
+    SHAKE_COUNT_COPIES( CombinationIterator, "CombinationIterator" );
+};
+
+//----------------------------------------------------------------
+// Iterates over the permutations of the elements of a random-access range, in lexicographic order of their indices.
+// Like the combination iterator, each permutation is a view through the indices inside the iterator,
+// and jumping to a rank unranks it with the factorial number system.
+template<typename iterator_t>
+class PermutationIterator
+{
+public:
+    // iterator traits
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type        = IndirectRange<iterator_t>;
+    using difference_type   = std::ptrdiff_t;
+    using pointer           = value_type*;
+    using reference         = value_type&;
+
+public:
+    PermutationIterator
+    (
+        const iterator_t&   begin_iterator,
+        std::size_t         n_elements,
+        std::uint64_t       rank
+    )
+        : m_begin_iterator  { begin_iterator }
+        , m_n_permutations  { combinatorics_detail::factorial( n_elements ) }
+        , m_indices         ( n_elements )
+    {
+        move_to( rank );
+    }
+
+    const std::vector<std::size_t>& get_internal_indices() const { return m_indices; }
+    std::uint64_t get_rank() const { return m_rank; }
+
+    PermutationIterator& operator++()
+    {
+        SHAKE_COUNT_OPERATION( PermutationIterator, "PermutationIterator", increments );
+        ++m_rank;
+        std::next_permutation( m_indices.begin(), m_indices.end() );
+        return *this;
+    }
+
+    PermutationIterator operator++(int) { PermutationIterator result = *this; ++(*this); return result; }
+
+    PermutationIterator&    operator--()                        { --m_rank; std::prev_permutation( m_indices.begin(), m_indices.end() ); return *this; }
+    PermutationIterator&    operator+=(difference_type n)       { move_to( m_rank + static_cast<std::uint64_t>( n ) ); return *this; }
+    PermutationIterator&    operator-=(difference_type n)       { return *this += -n; }
+    PermutationIterator     operator+ (difference_type n) const { PermutationIterator result = *this; return result += n; }
+    PermutationIterator     operator- (difference_type n) const { PermutationIterator result = *this; return result -= n; }
+    difference_type         operator- (const PermutationIterator& other) const { return static_cast<difference_type>( m_rank - other.m_rank ); }
+
+    bool operator==(const PermutationIterator& other) const { SHAKE_COUNT_OPERATION( PermutationIterator, "PermutationIterator", comparisons ); return m_rank == other.m_rank; }
+    bool operator!=(const PermutationIterator& other) const { return !(*this == other); }
+    bool operator< (const PermutationIterator& other) const { return m_rank < other.m_rank; }
+
+    value_type operator*() const
+    {
+        SHAKE_COUNT_OPERATION( PermutationIterator, "PermutationIterator", dereferences );
+        return Range
+        {
+            IndirectIterator<iterator_t> { m_begin_iterator, m_indices.data() },
+            IndirectIterator<iterator_t> { m_begin_iterator, m_indices.data() + m_indices.size() }
+        };
+    }
+
+private:
+    // Each digit of the rank in the factorial number system selects one of the remaining indices,
+    // which is rotated to the front of the remaining ones, so that these stay sorted, without allocating.
+    void move_to( std::uint64_t rank )
+    {
+        m_rank = rank;
+        std::iota( m_indices.begin(), m_indices.end(), std::size_t { 0 } );
+        if ( rank >= m_n_permutations )
+        {
+            return;
+        }
+        const auto n = m_indices.size();
+        auto n_per_digit = m_n_permutations;
+        for ( std::size_t i = 0; i < n; ++i )
+        {
+            n_per_digit /= ( n - i );
+            const auto digit = static_cast<std::ptrdiff_t>( rank / n_per_digit );
+            rank %= n_per_digit;
+            const auto first = m_indices.begin() + static_cast<std::ptrdiff_t>( i );
+            std::rotate( first, first + digit, first + digit + 1 );
+        }
+    }
+
+private:
+    iterator_t                  m_begin_iterator;
+    std::uint64_t               m_n_permutations;
+    std::uint64_t               m_rank;
+    std::vector<std::size_t>    m_indices;
+    SHAKE_COUNT_COPIES( PermutationIterator, "PermutationIterator" );
+};
+
+//----------------------------------------------------------------
+template<typename iterator_t>
+using CombinationRange = Range<CombinationIterator<iterator_t>>;
+
+template<typename iterator_t>
+using PermutationRange = Range<PermutationIterator<iterator_t>>;
+
+//----------------------------------------------------------------
+// The subsets of k elements of a random-access range, of which there should be fewer than 2^64.
+// The elements are referred to like the range refers to them, so they can be modified through non-const ranges.
+template<typename range_t>
+CombinationRange<typename range_t::iterator> combinations
+(
+    range_t         input_range,
+    std::size_t     k
+)
+{
+    using iterator_t = typename range_t::iterator;
+    static_assert
+    (
+        std::is_base_of_v<std::random_access_iterator_tag, typename std::iterator_traits<iterator_t>::iterator_category>,
+        "only the elements of random-access ranges can be combined"
+    );
+
+    const auto begin_iterator   = std::begin( input_range );
+    const auto n_elements       = static_cast<std::size_t>( std::end( input_range ) - begin_iterator );
+
+    return Range
+    {
+        CombinationIterator<iterator_t> { begin_iterator, n_elements, k, 0 },
+        CombinationIterator<iterator_t> { begin_iterator, n_elements, k, combinatorics_detail::binomial( n_elements, k ) }
+    };
+}
+
+//----------------------------------------------------------------
+// The permutations of the elements of a random-access range, of which there should be at most 20.
+template<typename range_t>
+PermutationRange<typename range_t::iterator> permutations
+(
+    range_t input_range
+)
+{
+    using iterator_t = typename range_t::iterator;
+    static_assert
+    (
+        std::is_base_of_v<std::random_access_iterator_tag, typename std::iterator_traits<iterator_t>::iterator_category>,
+        "only the elements of random-access ranges can be permuted"
+    );
+
+    const auto begin_iterator   = std::begin( input_range );
+    const auto n_elements       = static_cast<std::size_t>( std::end( input_range ) - begin_iterator );
+
+    return Range
+    {
+        PermutationIterator<iterator_t> { begin_iterator, n_elements, 0 },
+        PermutationIterator<iterator_t> { begin_iterator, n_elements, combinatorics_detail::factorial( n_elements ) }
+    };
+}
+
+} // namespace shake
+
+#endif // COMBINATORICS_RANGE_HPP
@@ -2,7 +2,11 @@
 #define COMBINE_RANGE_HPP
 
 #include <cstddef>
+#include <iterator>
 #include <tuple>
+#include <type_traits>
+
+#include "instrumentation.hpp"
 
 namespace shake {
 
@@ -25,57 +29,96 @@ public:
     // which dereferences each parameter from the pack using a fold expression,
     // and stores them again in a new tuple.
     // You could unpack the returned tuple again using std::tie or structured bindings.
-    // Because it is difficult to specify the type of a tuple that contains the elements
-    // corresponding to dereferencing the iterators in the variadic  parameter pack,
-    // we just auto-deduce the return type of this function and create an alias for it later.
-    auto operator*() const
+    constexpr auto operator*() const
     {
+        SHAKE_COUNT_OPERATION( CombineIterator, "CombineIterator", dereferences );
         return std::apply
         (
-            // use std::forward_as_tuple to maintain references
-            []( auto&&... args ) { return std::forward_as_tuple( ( *args ) ... ); },
+            // maintain references for iterators that dereference to references,
+            // but store values for iterators that dereference to temporaries, so that those do not dangle
+            []( auto&&... args ) { return std::tuple<decltype( *args ) ...>( ( *args ) ... ); },
             m_combined_ranges_iterator
         );
     }
 
 public:
     // iterator traits
-    using iterator_category = std::random_access_iterator_tag;
-    // here we use the auto-deduced return type from our packed dereferencing function
-    using value_type        = std::invoke_result_t< decltype( &CombineIterator<IteratorArgs...>::operator* )() >;
+    // only random-access if all combined iterators are
+    using iterator_category = std::conditional_t
+    <
+        ( std::is_base_of_v< std::random_access_iterator_tag, typename std::iterator_traits<IteratorArgs>::iterator_category > && ... ),
+        std::random_access_iterator_tag,
+        std::forward_iterator_tag
+    >;
+    // the tuple holds whatever dereferencing each of the combined iterators produces, like our dereferencing function
+    using value_type        = std::tuple<decltype( *std::declval<const IteratorArgs&>() ) ...>;
     using difference_type   = std::ptrdiff_t;
     using pointer           = value_type*;
-    using reference         = value_type&;
+    // the tuple is produced by value, although it can hold references to the elements
+    using reference         = value_type;
 
 public:
+    constexpr CombineIterator() = default;
 
     // The constructor simply stores all iterators in the parameter pack as a tuple
-    explicit
+    constexpr explicit
     CombineIterator( IteratorArgs... iterator_args )
         : m_combined_ranges_iterator { std::make_tuple( iterator_args... ) }
     { }
 
-    const tuple_t& get_internal_iterator() const { return m_combined_ranges_iterator; }
+    constexpr const tuple_t& get_internal_iterator() const { return m_combined_ranges_iterator; }
 
     // We take the tuple of the combined iterators,
     // passes it as a parameter pack to our lambda function using std::apply,
-    // which increments each parameter from the pack using a fold expression,
-    // and stores them again in a new tuple which replaces the old iterators.
-    CombineIterator& operator++()
+    // which increments each parameter from the pack in place using a fold expression.
+    // Incrementing in place avoids copying iterators that are expensive to copy.
+    constexpr CombineIterator& operator++()
     {
-        m_combined_ranges_iterator = std::apply
+        SHAKE_COUNT_OPERATION( CombineIterator, "CombineIterator", increments );
+        std::apply
         (
-            // use make_tuple because we want to create copies
-            []( auto&&... args ) { return std::make_tuple( ( ++args ) ... ); },
+            []( auto&... args ) { ( ++args, ... ); },
             m_combined_ranges_iterator
         );
         return *this;
     }
 
-    CombineIterator operator++(int) { CombineIterator result = *this; ++(*this); return result; }
+    constexpr CombineIterator operator++(int) { CombineIterator result = *this; ++(*this); return result; }
+
+    // Random-access operations apply to each combined iterator, in the same way as the increment.
+    // All combined iterators move in lockstep, so the distance between the first ones is the distance between all.
+    constexpr CombineIterator& operator--()
+    {
+        std::apply( []( auto&... args ) { ( --args, ... ); }, m_combined_ranges_iterator );
+        return *this;
+    }
+
+    constexpr CombineIterator& operator+=(difference_type n)
+    {
+        std::apply( [n]( auto&... args ) { ( ( args += n ), ... ); }, m_combined_ranges_iterator );
+        return *this;
+    }
+
+    constexpr CombineIterator  operator--(int)                     { CombineIterator result = *this; --(*this); return result; }
+    constexpr CombineIterator& operator-=(difference_type n)       { return *this += -n; }
+    constexpr CombineIterator  operator+ (difference_type n) const { CombineIterator result = *this; return result += n; }
+    constexpr CombineIterator  operator- (difference_type n) const { CombineIterator result = *this; return result -= n; }
+    constexpr difference_type  operator- (const CombineIterator& other) const
+    {
+        return std::get<0>( m_combined_ranges_iterator ) - std::get<0>( other.m_combined_ranges_iterator );
+    }
+
+    constexpr bool operator==(CombineIterator other) const { SHAKE_COUNT_OPERATION( CombineIterator, "CombineIterator", comparisons ); return get_internal_iterator() == other.get_internal_iterator(); }
+    constexpr bool operator!=(CombineIterator other) const { return !(*this == other); }
+    constexpr bool operator< (const CombineIterator& other) const { return ( *this - other ) <  0; }
+    constexpr bool operator> (const CombineIterator& other) const { return ( *this - other ) >  0; }
+    constexpr bool operator<=(const CombineIterator& other) const { return ( *this - other ) <= 0; }
+    constexpr bool operator>=(const CombineIterator& other) const { return ( *this - other ) >= 0; }
+
+    constexpr value_type operator[](difference_type n) const { return *( *this + n ); }
 
-    bool operator==(CombineIterator other) const { return get_internal_iterator() == other.get_internal_iterator(); }
-    bool operator!=(CombineIterator other) const { return !(*this == other); }
+    friend constexpr CombineIterator operator+( difference_type n, const CombineIterator& it ) { return it + n; }
+    SHAKE_COUNT_COPIES( CombineIterator, "CombineIterator" );
 };
 
 //----------------------------------------------------------------
@@ -87,7 +130,7 @@ using CombineRange = Range<CombineIterator<IteratorArgs...>>;
 // When dereferencing, you obtain a tuple with elements from all ranges combined.
 // The return type is auto-deduced, because it is super difficult to express it otherwise.
 template<typename... RangeArgs>
-auto combine
+constexpr auto combine
 (
     RangeArgs... range_args
 )
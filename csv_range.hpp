@@ -0,0 +1,348 @@
+#ifndef CSV_RANGE_HPP
+#define CSV_RANGE_HPP
+
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <optional>
+#include <string_view>
+#include <system_error>
+
+#include "instrumentation.hpp"
+#include "range.hpp"
+#include "transform_range.hpp"
+
+namespace shake {
+
+namespace csv_detail {
+
+//----------------------------------------------------------------
+// Finds the first occurrence of c in [begin, end), or returns end.
+// std::memchr is implemented with vector instructions by the standard libraries.
+inline const char* find( const char* begin, const char* end, char c )
+{
+    const auto found = static_cast<const char*>( std::memchr( begin, c, static_cast<std::size_t>( end - begin ) ) );
+    return found != nullptr ? found : end;
+}
+
+//----------------------------------------------------------------
+// Finds the newline that ends the row starting at begin, skipping newlines inside quoted fields.
+// Rows without quotes are found with a single scan for the newline and a single scan for a quote.
+inline const char* find_row_end( const char* begin, const char* end )
+{
+    auto newline = find( begin, end, '\n' );
+    auto quote = find( begin, newline, '"' );
+    while ( quote != newline )
+    {
+        // every quote toggles between quoted and unquoted, which also holds for escaped quotes ("")
+        const auto closing_quote = find( quote + 1, end, '"' );
+        if ( closing_quote == end )
+        {
+            return end;
+        }
+        newline = find( closing_quote + 1, end, '\n' );
+        quote   = find( closing_quote + 1, newline, '"' );
+    }
+    return newline;
+}
+
+} // namespace csv_detail
+
+//----------------------------------------------------------------
+// Iterates over the fields of a single row, and exposes them as string views into the buffer.
+// Quoted fields are exposed without their surrounding quotes.
+// Escaped quotes ("") inside them are left as they are, because they can not be unescaped without a copy.
+class CsvFieldIterator
+{
+public:
+    // iterator traits
+    using iterator_category = std::forward_iterator_tag;
+    using value_type        = std::string_view;
+    using difference_type   = std::ptrdiff_t;
+    using pointer           = const std::string_view*;
+    using reference         = std::string_view;
+
+public:
+    CsvFieldIterator
+    (
+        const char* field_begin,
+        const char* row_end,
+        char        delimiter,
+        bool        is_done = false
+    )
+        : m_field_begin { field_begin }
+        , m_field_end   { is_done ? row_end : find_field_end( field_begin, row_end, delimiter ) }
+        , m_row_end     { row_end }
+        , m_delimiter   { delimiter }
+        , m_is_done     { is_done }
+    { }
+
+    const char* get_internal_iterator() const { return m_field_begin; }
+
+    CsvFieldIterator& operator++()
+    {
+        SHAKE_COUNT_OPERATION( CsvFieldIterator, "CsvFieldIterator", increments );
+        // a row that ends with a delimiter still ends with an empty field
+        if ( m_field_end == m_row_end )
+        {
+            m_field_begin   = m_row_end;
+            m_is_done       = true;
+        }
+        else
+        {
+            m_field_begin   = m_field_end + 1;
+            m_field_end     = find_field_end( m_field_begin, m_row_end, m_delimiter );
+        }
+        return *this;
+    }
+
+    CsvFieldIterator operator++(int) { CsvFieldIterator result = *this; ++(*this); return result; }
+
+    bool operator==( const CsvFieldIterator& other ) const { SHAKE_COUNT_OPERATION( CsvFieldIterator, "CsvFieldIterator", comparisons ); return m_is_done == other.m_is_done && get_internal_iterator() == other.get_internal_iterator(); }
+    bool operator!=( const CsvFieldIterator& other ) const { return !( *this == other ); }
+
+    std::string_view operator*() const
+    {
+        SHAKE_COUNT_OPERATION( CsvFieldIterator, "CsvFieldIterator", dereferences );
+        const auto size = static_cast<std::size_t>( m_field_end - m_field_begin );
+        if ( size >= 2 && *m_field_begin == '"' && *( m_field_end - 1 ) == '"' )
+        {
+            return { m_field_begin + 1, size - 2 };
+        }
+        return { m_field_begin, size };
+    }
+
+private:
+    static const char* find_field_end( const char* begin, const char* end, char delimiter )
+    {
+        if ( begin != end && *begin == '"' )
+        {
+            // skip over the quoted part, in which delimiters do not count
+            auto quote = csv_detail::find( begin + 1, end, '"' );
+            while ( quote + 1 < end && *( quote + 1 ) == '"' )
+            {
+                quote = csv_detail::find( quote + 2, end, '"' );
+            }
+            begin = ( quote == end ) ? end : quote + 1;
+        }
+        return csv_detail::find( begin, end, delimiter );
+    }
+
+private:
+    const char* m_field_begin;
+    const char* m_field_end;
+    const char* m_row_end;
+    char        m_delimiter;
+    bool        m_is_done;
+    SHAKE_COUNT_COPIES( CsvFieldIterator, "CsvFieldIterator" );
+};
+
+//----------------------------------------------------------------
+using CsvFieldRange = Range<CsvFieldIterator>;
+
+//----------------------------------------------------------------
+// A lightweight view of a single row, which only finds its fields when asked for them.
+class CsvRow
+{
+public:
+    CsvRow
+    (
+        std::string_view    row,
+        char                delimiter
+    )
+        : m_row         { row }
+        , m_delimiter   { delimiter }
+    { }
+
+    std::string_view    text()   const { return m_row; }
+
+    CsvFieldRange fields() const
+    {
+        const auto row_end = m_row.data() + m_row.size();
+        return Range
+        {
+            CsvFieldIterator { m_row.data(),    row_end, m_delimiter },
+            CsvFieldIterator { row_end,         row_end, m_delimiter, true }
+        };
+    }
+
+    // Returns an empty view if the row has less fields
+    std::string_view operator[]( std::size_t index ) const
+    {
+        for ( const auto field : fields() )
+        {
+            if ( index-- == 0 )
+            {
+                return field;
+            }
+        }
+        return { };
+    }
+
+private:
+    std::string_view    m_row;
+    char                m_delimiter;
+};
+
+//----------------------------------------------------------------
+// Iterates over the rows of a buffer that is completely in memory.
+// Newlines inside quoted fields do not end a row, and a carriage return before a newline is not part of the row.
+class CsvRowIterator
+{
+public:
+    // iterator traits
+    using iterator_category = std::forward_iterator_tag;
+    using value_type        = CsvRow;
+    using difference_type   = std::ptrdiff_t;
+    using pointer           = const CsvRow*;
+    using reference         = CsvRow;
+
+public:
+    CsvRowIterator
+    (
+        const char* row_begin,
+        const char* data_end,
+        char        delimiter
+    )
+        : m_row_begin   { row_begin }
+        , m_row_end     { csv_detail::find_row_end( row_begin, data_end ) }
+        , m_data_end    { data_end }
+        , m_delimiter   { delimiter }
+    { }
+
+    const char* get_internal_iterator() const { return m_row_begin; }
+
+    CsvRowIterator& operator++()
+    {
+        SHAKE_COUNT_OPERATION( CsvRowIterator, "CsvRowIterator", increments );
+        m_row_begin = ( m_row_end == m_data_end ) ? m_data_end : m_row_end + 1;
+        m_row_end   = csv_detail::find_row_end( m_row_begin, m_data_end );
+        return *this;
+    }
+
+    CsvRowIterator operator++(int) { CsvRowIterator result = *this; ++(*this); return result; }
+
+    bool operator==( const CsvRowIterator& other ) const { SHAKE_COUNT_OPERATION( CsvRowIterator, "CsvRowIterator", comparisons ); return get_internal_iterator() == other.get_internal_iterator(); }
+    bool operator!=( const CsvRowIterator& other ) const { return !( *this == other ); }
+
+    CsvRow operator*() const
+    {
+        SHAKE_COUNT_OPERATION( CsvRowIterator, "CsvRowIterator", dereferences );
+        auto row_end = m_row_end;
+        if ( row_end != m_row_begin && *( row_end - 1 ) == '\r' )
+        {
+            --row_end;
+        }
+        return CsvRow { { m_row_begin, static_cast<std::size_t>( row_end - m_row_begin ) }, m_delimiter };
+    }
+
+private:
+    const char* m_row_begin;
+    const char* m_row_end;
+    const char* m_data_end;
+    char        m_delimiter;
+    SHAKE_COUNT_COPIES( CsvRowIterator, "CsvRowIterator" );
+};
+
+//----------------------------------------------------------------
+using CsvRowRange = Range<CsvRowIterator>;
+
+//----------------------------------------------------------------
+// The buffer is not copied, so it should outlive the range and everything it produces.
+inline CsvRowRange csv_rows
+(
+    std::string_view    buffer,
+    char                delimiter = ','
+)
+{
+    const auto data_end = buffer.data() + buffer.size();
+    return Range
+    {
+        CsvRowIterator { buffer.data(), data_end, delimiter },
+        CsvRowIterator { data_end,      data_end, delimiter }
+    };
+}
+
+//----------------------------------------------------------------
+inline CsvRowRange tsv_rows
+(
+    std::string_view buffer
+)
+{
+    return csv_rows( buffer, '\t' );
+}
+
+//----------------------------------------------------------------
+// Iterates over the rows that start within the bytes [begin_offset, end_offset) of the buffer.
+// Splitting a buffer at any set of offsets therefore visits every row exactly once,
+// so that the parts can be parsed in parallel.
+// This assumes that quoted fields do not contain newlines,
+// because it can not be known whether an offset lies within quotes without parsing from the start.
+inline CsvRowRange csv_rows
+(
+    std::string_view    buffer,
+    std::size_t         begin_offset,
+    std::size_t         end_offset,
+    char                delimiter = ','
+)
+{
+    // move an offset to the beginning of the first row that starts at or after it
+    const auto align_to_row = [ &buffer ]( std::size_t offset ) -> std::size_t
+    {
+        if ( offset == 0 || offset >= buffer.size() )
+        {
+            return std::min( offset, buffer.size() );
+        }
+        const auto newline = buffer.find( '\n', offset - 1 );
+        return newline == std::string_view::npos ? buffer.size() : newline + 1;
+    };
+
+    const auto aligned_begin    = align_to_row( begin_offset );
+    const auto aligned_end      = std::max( aligned_begin, align_to_row( end_offset ) );
+    return csv_rows( buffer.substr( aligned_begin, aligned_end - aligned_begin ), delimiter );
+}
+
+//----------------------------------------------------------------
+// Projects a single column out of a range of rows.
+// Multiple columns can be projected separately, and combined again using combine.
+template<typename range_t>
+auto column
+(
+    range_t         rows,
+    std::size_t     index
+)
+{
+    return transform<const CsvRow&, std::string_view>
+    (
+        rows,
+        [ index ]( const CsvRow& row ) -> std::string_view
+        {
+            return row[ index ];
+        }
+    );
+}
+
+//----------------------------------------------------------------
+// Parses a number from a field, using std::from_chars so that the locale is never consulted.
+// Returns an empty optional if the field does not completely consist of a number.
+template<typename T>
+std::optional<T> parse_field
+(
+    std::string_view field
+)
+{
+    auto value = T { };
+    const auto field_end = field.data() + field.size();
+    const auto [ parse_end, error ] = std::from_chars( field.data(), field_end, value );
+    if ( error != std::errc { } || parse_end != field_end )
+    {
+        return std::nullopt;
+    }
+    return value;
+}
+
+} // namespace shake
+
+#endif // CSV_RANGE_HPP
@@ -0,0 +1,329 @@
+#ifndef CURVE_RANGE_HPP
+#define CURVE_RANGE_HPP
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <tuple>
+
+#ifdef __BMI2__
+    #include <immintrin.h>
+#endif
+
+#include "instrumentation.hpp"
+#include "range.hpp"
+
+namespace shake {
+
+namespace curve_detail {
+
+//----------------------------------------------------------------
+// Interleaves the bits of x with zeros, so that bit i of x ends up at bit 2 * i of the result
+inline std::uint64_t spread_bits( std::uint32_t x )
+{
+#ifdef __BMI2__
+    return _pdep_u64( x, 0x5555555555555555 );
+#else
+    auto result = std::uint64_t { x };
+    result = ( result | ( result << 16 ) ) & 0x0000FFFF0000FFFF;
+    result = ( result | ( result <<  8 ) ) & 0x00FF00FF00FF00FF;
+    result = ( result | ( result <<  4 ) ) & 0x0F0F0F0F0F0F0F0F;
+    result = ( result | ( result <<  2 ) ) & 0x3333333333333333;
+    result = ( result | ( result <<  1 ) ) & 0x5555555555555555;
+    return result;
+#endif
+}
+
+// The inverse of spread_bits, which gathers the even bits
+inline std::uint32_t compact_bits( std::uint64_t code )
+{
+#ifdef __BMI2__
+    return static_cast<std::uint32_t>( _pext_u64( code, 0x5555555555555555 ) );
+#else
+    auto result = code & 0x5555555555555555;
+    result = ( result | ( result >>  1 ) ) & 0x3333333333333333;
+    result = ( result | ( result >>  2 ) ) & 0x0F0F0F0F0F0F0F0F;
+    result = ( result | ( result >>  4 ) ) & 0x00FF00FF00FF00FF;
+    result = ( result | ( result >>  8 ) ) & 0x0000FFFF0000FFFF;
+    result = ( result | ( result >> 16 ) ) & 0x00000000FFFFFFFF;
+    return static_cast<std::uint32_t>( result );
+#endif
+}
+
+//----------------------------------------------------------------
+struct Cell
+{
+    std::uint32_t x;
+    std::uint32_t y;
+};
+
+} // namespace curve_detail
+
+//----------------------------------------------------------------
+// The Z-order curve, which interleaves the bits of the coordinates, with x in the lowest bit.
+struct MortonCurve
+{
+    static curve_detail::Cell decode( std::uint64_t position, unsigned /* n_bits */ )
+    {
+        return { curve_detail::compact_bits( position ), curve_detail::compact_bits( position >> 1 ) };
+    }
+
+    static std::uint64_t encode( curve_detail::Cell cell, unsigned /* n_bits */ )
+    {
+        return curve_detail::spread_bits( cell.x ) | ( curve_detail::spread_bits( cell.y ) << 1 );
+    }
+};
+
+//----------------------------------------------------------------
+// The Hilbert curve, of which consecutive cells are always neighbours, unlike those of the Z-order curve.
+// Each level of the curve rotates and mirrors the quadrants, which takes a loop over the levels.
+struct HilbertCurve
+{
+    // Decodes from the top level down, keeping track of whether the quadrants below are swapped and mirrored,
+    // with xor instead of branches, since the quadrants along the curve are hard to predict.
+    static curve_detail::Cell decode( std::uint64_t position, unsigned n_bits )
+    {
+        auto cell   = curve_detail::Cell { 0, 0 };
+        auto swap   = std::uint32_t { 0 };
+        auto mirror = std::uint32_t { 0 };
+        for ( unsigned level = n_bits; level-- > 0; )
+        {
+            const auto quadrant = static_cast<std::uint32_t>( position >> ( 2 * level ) ) & 3;
+            const auto rx       = quadrant >> 1;
+            const auto ry       = ( quadrant ^ rx ) & 1;
+            auto x = rx ^ mirror;
+            auto y = ry ^ mirror;
+            const auto swapped = ( x ^ y ) & swap;
+            x ^= swapped;
+            y ^= swapped;
+            cell.x |= x << level;
+            cell.y |= y << level;
+            // the same rotation as encoding applies, for the levels below
+            const auto is_rotated = ry ^ 1;
+            swap   ^= is_rotated;
+            mirror ^= is_rotated & rx;
+        }
+        return cell;
+    }
+
+    static std::uint64_t encode( curve_detail::Cell cell, unsigned n_bits )
+    {
+        auto position = std::uint64_t { 0 };
+        for ( unsigned level = n_bits; level-- > 0; )
+        {
+            const auto size = std::uint32_t { 1 } << level;
+            const auto rx   = ( cell.x & size ) != 0 ? 1U : 0U;
+            const auto ry   = ( cell.y & size ) != 0 ? 1U : 0U;
+            position += std::uint64_t { size } * size * ( ( 3 * rx ) ^ ry );
+            rotate( cell, size, rx, ry );
+        }
+        return position;
+    }
+
+private:
+    static void rotate( curve_detail::Cell& cell, std::uint32_t size, std::uint32_t rx, std::uint32_t ry )
+    {
+        if ( ry == 0 )
+        {
+            if ( rx == 1 )
+            {
+                // only the bits below the level matter, so the wrap around of the subtraction is harmless
+                cell.x = size - 1 - cell.x;
+                cell.y = size - 1 - cell.y;
+            }
+            std::swap( cell.x, cell.y );
+        }
+    }
+};
+
+//----------------------------------------------------------------
+// Iterates over the cells of a width by height grid in the order of a space-filling curve,
+// so that cells that are visited close together in time are also close together in space, at every scale.
+// The curve covers the smallest enclosing square with a power of two as size, and the cells outside the grid are skipped.
+// It is random-access by the rank of a cell among the cells inside the grid, so it can be split into balanced parts.
+// Jumping to a rank descends the quadrants of the curve, counting the cells inside the grid,
+// because each aligned block of curve positions covers an aligned square block of cells.
+template<typename curve_t>
+class CurveIterator
+{
+public:
+    // iterator traits
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type        = std::tuple<std::size_t, std::size_t>;
+    using difference_type   = std::ptrdiff_t;
+    using pointer           = value_type*;
+    using reference         = value_type&;
+
+public:
+    CurveIterator
+    (
+        std::uint32_t   width,
+        std::uint32_t   height,
+        std::uint64_t   rank
+    )
+        : m_width   { width }
+        , m_height  { height }
+        , m_n_bits  { static_cast<unsigned>( std::bit_width( std::max<std::uint32_t>( std::max( width, height ), 1 ) - 1 ) ) }
+    {
+        move_to( rank );
+    }
+
+    std::uint64_t get_curve_position()  const { return m_position; }
+    std::uint64_t get_rank()            const { return m_rank; }
+
+    CurveIterator& operator++()
+    {
+        SHAKE_COUNT_OPERATION( CurveIterator, "CurveIterator", increments );
+        if ( ++m_rank == size() )
+        {
+            move_to( m_rank );
+            return *this;
+        }
+        // usually the next position on the curve is inside the grid, otherwise skip the blocks outside of it
+        m_cell = curve_t::decode( ++m_position, m_n_bits );
+        while ( !is_inside( m_cell ) )
+        {
+            skip_outside();
+        }
+        return *this;
+    }
+
+    CurveIterator operator++(int) { CurveIterator result = *this; ++(*this); return result; }
+
+    CurveIterator&  operator--()                        { move_to( m_rank - 1 ); return *this; }
+    CurveIterator   operator--(int)                     { CurveIterator result = *this; --(*this); return result; }
+    CurveIterator&  operator+=(difference_type n)       { move_to( m_rank + static_cast<std::uint64_t>( n ) ); return *this; }
+    CurveIterator&  operator-=(difference_type n)       { return *this += -n; }
+    CurveIterator   operator+ (difference_type n) const { CurveIterator result = *this; return result += n; }
+    CurveIterator   operator- (difference_type n) const { CurveIterator result = *this; return result -= n; }
+    difference_type operator- (const CurveIterator& other) const { return static_cast<difference_type>( m_rank - other.m_rank ); }
+
+    bool operator==(const CurveIterator& other) const { SHAKE_COUNT_OPERATION( CurveIterator, "CurveIterator", comparisons ); return m_rank == other.m_rank; }
+    bool operator!=(const CurveIterator& other) const { return !(*this == other); }
+    bool operator< (const CurveIterator& other) const { return m_rank < other.m_rank; }
+
+    value_type operator*() const
+    {
+        SHAKE_COUNT_OPERATION( CurveIterator, "CurveIterator", dereferences );
+        return { m_cell.x, m_cell.y };
+    }
+
+    value_type operator[](difference_type n) const { return *( *this + n ); }
+
+private:
+    std::uint64_t size() const { return std::uint64_t { m_width } * m_height; }
+
+    bool is_inside( curve_detail::Cell cell ) const { return cell.x < m_width && cell.y < m_height; }
+
+    // The number of cells inside the grid, of the square block of cells with the origin and the size
+    std::uint64_t n_inside( curve_detail::Cell origin, std::uint64_t block_size ) const
+    {
+        const auto n_columns = std::min<std::uint64_t>( m_width  - std::min( origin.x, m_width  ), block_size );
+        const auto n_rows    = std::min<std::uint64_t>( m_height - std::min( origin.y, m_height ), block_size );
+        return n_columns * n_rows;
+    }
+
+    // Skips the largest aligned block of curve positions that starts at the current position, and has no cells inside the grid.
+    // The block covers an aligned square of cells, which contains the current cell, so its origin follows from masking.
+    // Along a thin grid, the blocks grow and shrink again, so a gap is skipped in a few steps per level,
+    // instead of descending from the top level for every cell outside the grid.
+    void skip_outside()
+    {
+        auto level = std::min<unsigned>( static_cast<unsigned>( std::countr_zero( m_position ) ) / 2, m_n_bits );
+        for ( ; level > 0; --level )
+        {
+            const auto block_mask = ~( ( std::uint32_t { 1 } << level ) - 1 );
+            if ( n_inside( { m_cell.x & block_mask, m_cell.y & block_mask }, std::uint64_t { 1 } << level ) == 0 )
+            {
+                break;
+            }
+        }
+        m_position  += std::uint64_t { 1 } << ( 2 * level );
+        m_cell      = curve_t::decode( m_position, m_n_bits );
+    }
+
+    // Moves to the cell with the rank, by descending the quadrants of the curve from the top level,
+    // and skipping those quadrants that contain no more than the remaining rank of cells inside the grid.
+    void move_to( std::uint64_t rank )
+    {
+        m_rank = rank;
+        if ( rank >= size() )
+        {
+            // the end, past the last position on the curve
+            m_position  = std::uint64_t { 1 } << ( 2 * m_n_bits );
+            m_cell      = { 0, 0 };
+            return;
+        }
+        auto position = std::uint64_t { 0 };
+        for ( auto level = m_n_bits; level-- > 0; )
+        {
+            const auto block_size   = std::uint64_t { 1 } << level;
+            const auto block_mask   = ~static_cast<std::uint32_t>( block_size - 1 );
+            for ( std::uint64_t quadrant = 0; quadrant < 4; ++quadrant )
+            {
+                const auto block_position   = position + quadrant * block_size * block_size;
+                const auto cell             = curve_t::decode( block_position, m_n_bits );
+                const auto n                = n_inside( { cell.x & block_mask, cell.y & block_mask }, block_size );
+                if ( rank < n )
+                {
+                    position = block_position;
+                    break;
+                }
+                rank -= n;
+            }
+        }
+        m_position  = position;
+        m_cell      = curve_t::decode( position, m_n_bits );
+    }
+
+private:
+    std::uint32_t           m_width;
+    std::uint32_t           m_height;
+    unsigned                m_n_bits;
+    std::uint64_t           m_rank;
+    std::uint64_t           m_position;
+    curve_detail::Cell      m_cell;
+    SHAKE_COUNT_COPIES( CurveIterator, "CurveIterator" );
+};
+
+//----------------------------------------------------------------
+template<typename curve_t>
+using CurveRange = Range<CurveIterator<curve_t>>;
+
+//----------------------------------------------------------------
+// Yields the ( x, y ) cells of a width by height grid in Z-order.
+// Both sizes should be smaller than 2^31.
+inline CurveRange<MortonCurve> morton_range
+(
+    std::uint32_t width,
+    std::uint32_t height
+)
+{
+    return Range
+    {
+        CurveIterator<MortonCurve> { width, height, 0 },
+        CurveIterator<MortonCurve> { width, height, std::uint64_t { width } * height }
+    };
+}
+
+//----------------------------------------------------------------
+// Yields the ( x, y ) cells of a width by height grid in Hilbert order.
+// Both sizes should be smaller than 2^31.
+inline CurveRange<HilbertCurve> hilbert_range
+(
+    std::uint32_t width,
+    std::uint32_t height
+)
+{
+    return Range
+    {
+        CurveIterator<HilbertCurve> { width, height, 0 },
+        CurveIterator<HilbertCurve> { width, height, std::uint64_t { width } * height }
+    };
+}
+
+} // namespace shake
+
+#endif // CURVE_RANGE_HPP
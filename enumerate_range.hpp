@@ -10,7 +10,7 @@
 namespace shake {
 
 template<typename range_t>
-auto enumerate( range_t input_range )
+constexpr auto enumerate( range_t input_range )
 {
     // The enumerate functionality is very easily achieved by using our already existing CombineIterator and IndexIterator
 	const auto size = static_cast<std::size_t>( std::distance( std::begin( input_range ), std::end( input_range ) ) );
@@ -0,0 +1,275 @@
+#ifndef FLATTEN_RANGE_HPP
+#define FLATTEN_RANGE_HPP
+
+#include <cstddef>
+#include <iterator>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+#include "instrumentation.hpp"
+#include "range.hpp"
+
+namespace shake {
+
+//----------------------------------------------------------------
+// Iterates over the elements of the inner ranges of a range of ranges, like two nested loops.
+// The inner ranges can be containers, when the outer range refers to them, or ranges, which may be temporaries.
+// The iterator always points to an element of a non-empty inner range, or to the end of the outer range,
+// so empty inner ranges are skipped once, when moving to the next inner range.
+template<typename outer_iterator_t>
+class FlattenIterator
+{
+public:
+    using outer_reference_t = typename std::iterator_traits<outer_iterator_t>::reference;
+    using inner_iterator_t  = decltype( std::begin( std::declval<outer_reference_t>() ) );
+
+    static_assert
+    (
+        std::is_lvalue_reference_v<outer_reference_t> || is_range_v<std::remove_cvref_t<outer_reference_t>>,
+        "the inner ranges of a temporary container would not outlive the iterator"
+    );
+
+public:
+    // iterator traits
+    using iterator_category = std::forward_iterator_tag;
+    using reference         = decltype( *std::declval<const inner_iterator_t&>() );
+    using value_type        = std::remove_cvref_t<reference>;
+    using difference_type   = std::ptrdiff_t;
+    using pointer           = std::add_pointer_t<reference>;
+
+public:
+    // Starts at the first element of the first non-empty inner range, from the outer iterator on
+    FlattenIterator
+    (
+        const outer_iterator_t& outer_iterator,
+        const outer_iterator_t& outer_end_iterator
+    )
+        : m_outer_iterator      { outer_iterator }
+        , m_outer_end_iterator  { outer_end_iterator }
+    {
+        enter_inner_range();
+    }
+
+    // Starts at an element of the inner range that the outer iterator points to, which should not be its end
+    FlattenIterator
+    (
+        const outer_iterator_t& outer_iterator,
+        const outer_iterator_t& outer_end_iterator,
+        const inner_iterator_t& inner_iterator,
+        const inner_iterator_t& inner_end_iterator
+    )
+        : m_outer_iterator      { outer_iterator }
+        , m_outer_end_iterator  { outer_end_iterator }
+        , m_inner_iterator      { inner_iterator }
+        , m_inner_end_iterator  { inner_end_iterator }
+    { }
+
+    const outer_iterator_t& get_internal_iterator()     const { return m_outer_iterator; }
+    const outer_iterator_t& get_outer_end_iterator()    const { return m_outer_end_iterator; }
+    bool                    is_end()                    const { return m_outer_iterator == m_outer_end_iterator; }
+
+    // Only valid when the iterator is not at the end
+    const inner_iterator_t& get_inner_iterator()        const { return *m_inner_iterator; }
+    const inner_iterator_t& get_inner_end_iterator()    const { return *m_inner_end_iterator; }
+
+    FlattenIterator& operator++()
+    {
+        SHAKE_COUNT_OPERATION( FlattenIterator, "FlattenIterator", increments );
+        if ( ++*m_inner_iterator == *m_inner_end_iterator )
+        {
+            next_inner_range();
+        }
+        return *this;
+    }
+
+    FlattenIterator operator++(int) { FlattenIterator result = *this; ++(*this); return result; }
+
+    // Moves to the first element of the next non-empty inner range, or to the end
+    FlattenIterator& next_inner_range()
+    {
+        ++m_outer_iterator;
+        enter_inner_range();
+        return *this;
+    }
+
+    bool operator==(const FlattenIterator& other) const
+    {
+        SHAKE_COUNT_OPERATION( FlattenIterator, "FlattenIterator", comparisons );
+        return m_outer_iterator == other.m_outer_iterator && ( is_end() || *m_inner_iterator == *other.m_inner_iterator );
+    }
+
+    bool operator!=(const FlattenIterator& other) const { return !(*this == other); }
+
+    reference operator*() const
+    {
+        SHAKE_COUNT_OPERATION( FlattenIterator, "FlattenIterator", dereferences );
+        return **m_inner_iterator;
+    }
+
+private:
+    void enter_inner_range()
+    {
+        for ( ; m_outer_iterator != m_outer_end_iterator; ++m_outer_iterator )
+        {
+            auto&& inner_range = *m_outer_iterator;
+            auto begin_iterator = std::begin( inner_range );
+            auto end_iterator   = std::end( inner_range );
+            if ( begin_iterator != end_iterator )
+            {
+                m_inner_iterator.emplace( std::move( begin_iterator ) );
+                m_inner_end_iterator.emplace( std::move( end_iterator ) );
+                return;
+            }
+        }
+        m_inner_iterator.reset();
+        m_inner_end_iterator.reset();
+    }
+
+private:
+    outer_iterator_t                    m_outer_iterator;
+    outer_iterator_t                    m_outer_end_iterator;
+    // empty at the end, since there is no inner range to point into
+    std::optional<inner_iterator_t>     m_inner_iterator;
+    std::optional<inner_iterator_t>     m_inner_end_iterator;
+    SHAKE_COUNT_COPIES( FlattenIterator, "FlattenIterator" );
+};
+
+//----------------------------------------------------------------
+template<typename outer_iterator_t>
+using FlattenRange = Range<FlattenIterator<outer_iterator_t>>;
+
+//----------------------------------------------------------------
+template<typename T>
+struct is_flatten_iterator : std::false_type { };
+
+template<typename outer_iterator_t>
+struct is_flatten_iterator<FlattenIterator<outer_iterator_t>> : std::true_type { };
+
+template<typename T>
+inline constexpr bool is_flatten_iterator_v = is_flatten_iterator<T>::value;
+
+//----------------------------------------------------------------
+// Iterates over the elements of all inner ranges of the range, one inner range after another.
+template<typename range_t>
+FlattenRange<typename range_t::iterator> flatten
+(
+    range_t input_range
+)
+{
+    using iterator_t = FlattenIterator<typename range_t::iterator>;
+
+    const auto begin_iterator   = std::begin( input_range );
+    const auto end_iterator     = std::end( input_range );
+
+    return Range
+    {
+        iterator_t { begin_iterator, end_iterator },
+        iterator_t { end_iterator,   end_iterator }
+    };
+}
+
+//----------------------------------------------------------------
+// Calls the function with each non-empty part of an inner range that the flattened range covers, as a range.
+// This is what the algorithms use to iterate over each inner range with a loop of its own.
+template<typename outer_iterator_t, typename function_t>
+void for_each_segment
+(
+    const FlattenRange<outer_iterator_t>&   flat_range,
+    function_t&&                            function
+)
+{
+    auto it = flat_range.begin();
+    const auto end_iterator = flat_range.end();
+    for ( ; it.get_internal_iterator() != end_iterator.get_internal_iterator(); it.next_inner_range() )
+    {
+        function( Range { it.get_inner_iterator(), it.get_inner_end_iterator() } );
+    }
+    // a split part can end inside an inner range
+    if ( !it.is_end() && it.get_inner_iterator() != end_iterator.get_inner_iterator() )
+    {
+        function( Range { it.get_inner_iterator(), end_iterator.get_inner_iterator() } );
+    }
+}
+
+//----------------------------------------------------------------
+// The number of elements of a flattened range of random-access inner ranges,
+// which only takes a single step per inner range.
+template<typename outer_iterator_t>
+std::size_t flat_size
+(
+    const FlattenRange<outer_iterator_t>& flat_range
+)
+{
+    auto size = std::size_t { 0 };
+    for_each_segment( flat_range, [ & ]( const auto& segment ) { size += static_cast<std::size_t>( segment.end() - segment.begin() ); } );
+    return size;
+}
+
+//----------------------------------------------------------------
+// Returns one of n_parts consecutive parts of a flattened range of random-access inner ranges,
+// with numbers of elements that differ by at most one, however unevenly the elements are spread over the inner ranges.
+// Finding the part takes a single step per inner range.
+template<typename outer_iterator_t>
+FlattenRange<outer_iterator_t> split
+(
+    const FlattenRange<outer_iterator_t>&   flat_range,
+    std::size_t                             n_parts,
+    std::size_t                             part
+)
+{
+    using iterator_t = FlattenIterator<outer_iterator_t>;
+
+    static_assert
+    (
+        std::is_base_of_v<std::random_access_iterator_tag, typename std::iterator_traits<typename iterator_t::inner_iterator_t>::iterator_category>,
+        "only flattened ranges of random-access ranges can be split"
+    );
+
+    const auto size = flat_size( flat_range );
+    // like the split of a single range, the first size % n_parts parts get one extra element
+    const auto part_begin = [ & ]( std::size_t p ) { return p * ( size / n_parts ) + ( p < size % n_parts ? p : size % n_parts ); };
+
+    // the iterator at an offset points into the inner range that contains it, never to the end of an inner range
+    const auto iterator_at = [ & ]( std::size_t offset )
+    {
+        auto it = flat_range.begin();
+        for ( ; it.get_internal_iterator() != flat_range.end().get_internal_iterator(); it.next_inner_range() )
+        {
+            const auto inner_size = static_cast<std::size_t>( it.get_inner_end_iterator() - it.get_inner_iterator() );
+            if ( offset < inner_size )
+            {
+                return iterator_t
+                {
+                    it.get_internal_iterator(),
+                    it.get_outer_end_iterator(),
+                    it.get_inner_iterator() + static_cast<std::ptrdiff_t>( offset ),
+                    it.get_inner_end_iterator()
+                };
+            }
+            offset -= inner_size;
+        }
+        // the rest is in the inner range that a split part ends in, or else at the end
+        if ( !it.is_end() && offset < static_cast<std::size_t>( flat_range.end().get_inner_iterator() - it.get_inner_iterator() ) )
+        {
+            return iterator_t
+            {
+                it.get_internal_iterator(),
+                it.get_outer_end_iterator(),
+                it.get_inner_iterator() + static_cast<std::ptrdiff_t>( offset ),
+                it.get_inner_end_iterator()
+            };
+        }
+        return flat_range.end();
+    };
+
+    return Range
+    {
+        iterator_at( part_begin( part ) ),
+        iterator_at( part_begin( part + 1 ) )
+    };
+}
+
+} // namespace shake
+
+#endif // FLATTEN_RANGE_HPP
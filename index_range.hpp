@@ -4,6 +4,7 @@
 #include <cstddef>
 #include <iterator>
 
+#include "instrumentation.hpp"
 #include "range.hpp"
 
 namespace shake {
@@ -19,41 +20,63 @@ private:
 
 public:
     // iterator traits
-    using iterator_category = std::forward_iterator_tag;
+    using iterator_category = std::random_access_iterator_tag;
     using value_type        = index_t;
     using difference_type   = std::ptrdiff_t;
-    using pointer           = index_t*;
-    using reference         = index_t&;
+    using pointer           = const index_t*;
+    // the index is produced by value, like std::views::iota does, so that indexing with [] can produce it as well
+    using reference         = index_t;
 
 public:
+    constexpr IndexIterator() = default;
 
-    explicit
-    IndexIterator( index_t  index ) 
+    constexpr explicit
+    IndexIterator( index_t  index )
         : m_current_index { index } 
     { }
 
-    const index_t& get_internal_index() const { return m_current_index; }
+    constexpr const index_t& get_internal_index() const { return m_current_index; }
 
-    IndexIterator&  operator++()       { ++m_current_index; return *this; }
-    IndexIterator   operator++(int)    { IndexIterator result = *this; ++(*this); return result; }
+    constexpr IndexIterator&  operator++()       { SHAKE_COUNT_OPERATION( IndexIterator, "IndexIterator", increments ); ++m_current_index; return *this; }
+    constexpr IndexIterator   operator++(int)    { IndexIterator result = *this; ++(*this); return result; }
+    constexpr IndexIterator&  operator--()       { --m_current_index; return *this; }
+    constexpr IndexIterator   operator--(int)    { IndexIterator result = *this; --(*this); return result; }
 
-    bool operator==(IndexIterator other) const { return get_internal_index() == other.get_internal_index(); }
-    bool operator!=(IndexIterator other) const { return !(*this == other); }
+    constexpr IndexIterator&  operator+=(difference_type n)      { m_current_index += n; return *this; }
+    constexpr IndexIterator&  operator-=(difference_type n)      { m_current_index -= n; return *this; }
+    constexpr IndexIterator   operator+ (difference_type n) const { return IndexIterator { m_current_index + n }; }
+    constexpr IndexIterator   operator- (difference_type n) const { return IndexIterator { m_current_index - n }; }
+    constexpr difference_type operator- (IndexIterator other) const { return static_cast<difference_type>( m_current_index - other.m_current_index ); }
 
-    const index_t& operator*() const
+    constexpr bool operator==(IndexIterator other) const { SHAKE_COUNT_OPERATION( IndexIterator, "IndexIterator", comparisons ); return get_internal_index() == other.get_internal_index(); }
+    constexpr bool operator!=(IndexIterator other) const { return !(*this == other); }
+    constexpr bool operator< (IndexIterator other) const { return get_internal_index() <  other.get_internal_index(); }
+    constexpr bool operator> (IndexIterator other) const { return get_internal_index() >  other.get_internal_index(); }
+    constexpr bool operator<=(IndexIterator other) const { return get_internal_index() <= other.get_internal_index(); }
+    constexpr bool operator>=(IndexIterator other) const { return get_internal_index() >= other.get_internal_index(); }
+
+    constexpr index_t operator[](difference_type n) const { return m_current_index + n; }
+
+    friend constexpr IndexIterator operator+( difference_type n, IndexIterator it ) { return it + n; }
+
+    constexpr index_t operator*() const
     {
+        SHAKE_COUNT_OPERATION( IndexIterator, "IndexIterator", dereferences );
         return m_current_index;
     }
 
 private:
-    index_t m_current_index;
+    index_t m_current_index = 0;
+    SHAKE_COUNT_COPIES( IndexIterator, "IndexIterator" );
 };
 
+static_assert( std::random_access_iterator<IndexIterator> );
+
 //----------------------------------------------------------------
 using IndexRange = Range<IndexIterator>;
 
 //----------------------------------------------------------------
-IndexRange range
+constexpr IndexRange range
 (
     const std::size_t& begin_index,
     const std::size_t& end_index
@@ -67,7 +90,7 @@ IndexRange range
 }
 
 //----------------------------------------------------------------
-IndexRange range
+constexpr IndexRange range
 (
     const std::size_t& end_index
 )
@@ -0,0 +1,183 @@
+#ifndef INSTRUMENTATION_HPP
+#define INSTRUMENTATION_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <type_traits>
+
+namespace shake {
+
+//----------------------------------------------------------------
+// How often each kind of operation was performed on the iterators with a certain label.
+struct OperationCounts
+{
+    using counter_t = std::atomic<std::uint64_t>;
+
+    counter_t increments    { 0 };
+    counter_t dereferences  { 0 };
+    counter_t comparisons   { 0 };
+    counter_t copies        { 0 };
+    counter_t invocations   { 0 };
+};
+
+//----------------------------------------------------------------
+// Keeps the operation counts of all labels, and prints them when the program exits.
+// Looking up a label takes a lock, so iterators look up their counts once, and then only increment atomics.
+class InstrumentationRegistry
+{
+public:
+    static InstrumentationRegistry& instance()
+    {
+        static auto registry = InstrumentationRegistry { };
+        return registry;
+    }
+
+    InstrumentationRegistry( const InstrumentationRegistry& ) = delete;
+    InstrumentationRegistry& operator=( const InstrumentationRegistry& ) = delete;
+
+    ~InstrumentationRegistry()
+    {
+        report( std::cerr );
+    }
+
+    // The returned counts stay valid for as long as the registry exists
+    OperationCounts& counts( const std::string& label )
+    {
+        const auto lock = std::lock_guard { m_mutex };
+        auto& counts = m_counts[ label ];
+        if ( counts == nullptr )
+        {
+            counts = std::make_unique<OperationCounts>();
+        }
+        return *counts;
+    }
+
+    void reset()
+    {
+        const auto lock = std::lock_guard { m_mutex };
+        for ( auto& [ label, counts ] : m_counts )
+        {
+            for ( auto* counter : { &counts->increments, &counts->dereferences, &counts->comparisons, &counts->copies, &counts->invocations } )
+            {
+                counter->store( 0, std::memory_order_relaxed );
+            }
+        }
+    }
+
+    // Prints a table with a row per label, leaving out labels of which no operations were counted
+    void report( std::ostream& stream ) const
+    {
+        const auto lock = std::lock_guard { m_mutex };
+        auto has_printed_header = false;
+        for ( const auto& [ label, counts ] : m_counts )
+        {
+            const auto values =
+            {
+                counts->increments.load(), counts->dereferences.load(), counts->comparisons.load(), counts->copies.load(), counts->invocations.load()
+            };
+            if ( std::all_of( values.begin(), values.end(), []( std::uint64_t value ) { return value == 0; } ) )
+            {
+                continue;
+            }
+            if ( !has_printed_header )
+            {
+                stream << "shake instrumentation report\n" << std::left << std::setw( 24 ) << "label" << std::right;
+                for ( const auto* column : { "increments", "dereferences", "comparisons", "copies", "invocations" } )
+                {
+                    stream << std::setw( 16 ) << column;
+                }
+                stream << "\n";
+                has_printed_header = true;
+            }
+            stream << std::left << std::setw( 24 ) << label << std::right;
+            for ( const auto value : values )
+            {
+                stream << std::setw( 16 ) << value;
+            }
+            stream << "\n";
+        }
+    }
+
+private:
+    InstrumentationRegistry() = default;
+
+private:
+    mutable std::mutex                                          m_mutex;
+    std::map<std::string, std::unique_ptr<OperationCounts>>     m_counts;
+};
+
+//----------------------------------------------------------------
+// Counts an operation for the label. The counts are looked up once per tag type,
+// which is usually the iterator type itself, so that counting only costs an atomic increment.
+template<typename tag_t>
+void count_operation
+(
+    const char*                                         label,
+    OperationCounts::counter_t OperationCounts::*       operation
+)
+{
+    static auto& counts = InstrumentationRegistry::instance().counts( label );
+    ( counts.*operation ).fetch_add( 1, std::memory_order_relaxed );
+}
+
+//----------------------------------------------------------------
+// A member that counts how often the iterator it is part of is copied.
+// Copies during constant evaluation are not counted, so that constexpr iterators stay constexpr.
+template<typename tag_t>
+class CopyCounter
+{
+public:
+    constexpr explicit
+    CopyCounter( const char* label )
+        : m_label { label }
+    { }
+
+    constexpr CopyCounter( const CopyCounter& other )
+        : m_label { other.m_label }
+    {
+        if ( !std::is_constant_evaluated() )
+        {
+            count_operation<tag_t>( m_label, &OperationCounts::copies );
+        }
+    }
+
+    constexpr CopyCounter& operator=( const CopyCounter& other )
+    {
+        m_label = other.m_label;
+        if ( !std::is_constant_evaluated() )
+        {
+            count_operation<tag_t>( m_label, &OperationCounts::copies );
+        }
+        return *this;
+    }
+
+private:
+    const char* m_label;
+};
+
+} // namespace shake
+
+//----------------------------------------------------------------
+// Define SHAKE_INSTRUMENTATION to count the operations on all built-in iterators.
+// Without it, these macros expand to nothing, so instrumentation costs nothing.
+// Operations during constant evaluation are never counted.
+#ifdef SHAKE_INSTRUMENTATION
+    #define SHAKE_COUNT_OPERATION( iterator_type, label, operation ) \
+        ( std::is_constant_evaluated() ? static_cast<void>( 0 ) : ::shake::count_operation<iterator_type>( label, &::shake::OperationCounts::operation ) )
+    #define SHAKE_COUNT_COPIES( iterator_type, label ) \
+        ::shake::CopyCounter<iterator_type> m_copy_counter { label }
+#else
+    #define SHAKE_COUNT_OPERATION( iterator_type, label, operation ) \
+        static_cast<void>( 0 )
+    #define SHAKE_COUNT_COPIES( iterator_type, label ) \
+        static_assert( true, "" )
+#endif
+
+#endif // INSTRUMENTATION_HPP
@@ -0,0 +1,123 @@
+#ifndef INSTRUMENTED_RANGE_HPP
+#define INSTRUMENTED_RANGE_HPP
+
+#include <cstddef>
+#include <iterator>
+#include <string>
+
+#include "instrumentation.hpp"
+#include "range.hpp"
+
+namespace shake {
+
+//----------------------------------------------------------------
+// Wraps an iterator, and counts the operations performed on it under a label.
+// Wrapping the layers of a pipeline of ranges with different labels shows which layer does the work.
+// The counts are printed when the program exits, or can be read from the InstrumentationRegistry.
+template<typename iterator_t>
+class InstrumentedIterator
+{
+public:
+    // iterator traits
+    using iterator_category = typename std::iterator_traits<iterator_t>::iterator_category;
+    using value_type        = typename std::iterator_traits<iterator_t>::value_type;
+    using difference_type   = typename std::iterator_traits<iterator_t>::difference_type;
+    using pointer           = typename std::iterator_traits<iterator_t>::pointer;
+    using reference         = typename std::iterator_traits<iterator_t>::reference;
+
+public:
+    InstrumentedIterator
+    (
+        const iterator_t&   iterator,
+        OperationCounts&    counts
+    )
+        : m_iterator    { iterator }
+        , m_counts      { &counts }
+    { }
+
+    InstrumentedIterator( const InstrumentedIterator& other )
+        : m_iterator    { other.m_iterator }
+        , m_counts      { other.m_counts }
+    {
+        count( m_counts->copies );
+    }
+
+    InstrumentedIterator& operator=( const InstrumentedIterator& other )
+    {
+        m_iterator  = other.m_iterator;
+        m_counts    = other.m_counts;
+        count( m_counts->copies );
+        return *this;
+    }
+
+    const iterator_t& get_internal_iterator() const { return m_iterator; }
+
+    InstrumentedIterator&  operator++()       { count( m_counts->increments ); ++m_iterator; return *this; }
+    InstrumentedIterator   operator++(int)    { InstrumentedIterator result = *this; ++(*this); return result; }
+
+    // Only available when the internal iterator supports them, like its iterator_category says.
+    // Moving backwards and jumping are counted as increments as well.
+    InstrumentedIterator&   operator--()                        { count( m_counts->increments ); --m_iterator; return *this; }
+    InstrumentedIterator    operator--(int)                     { InstrumentedIterator result = *this; --(*this); return result; }
+    InstrumentedIterator&   operator+=(difference_type n)       { count( m_counts->increments ); m_iterator += n; return *this; }
+    InstrumentedIterator&   operator-=(difference_type n)       { count( m_counts->increments ); m_iterator -= n; return *this; }
+    InstrumentedIterator    operator+ (difference_type n) const { InstrumentedIterator result = *this; return result += n; }
+    InstrumentedIterator    operator- (difference_type n) const { InstrumentedIterator result = *this; return result -= n; }
+    difference_type         operator- (const InstrumentedIterator& other) const { return m_iterator - other.m_iterator; }
+    friend InstrumentedIterator operator+( difference_type n, const InstrumentedIterator& it ) { return it + n; }
+
+    bool operator==(const InstrumentedIterator& other) const { count( m_counts->comparisons ); return get_internal_iterator() == other.get_internal_iterator(); }
+    bool operator!=(const InstrumentedIterator& other) const { return !(*this == other); }
+    bool operator< (const InstrumentedIterator& other) const { count( m_counts->comparisons ); return m_iterator <  other.m_iterator; }
+    bool operator> (const InstrumentedIterator& other) const { return other < *this; }
+    bool operator<=(const InstrumentedIterator& other) const { return !( other < *this ); }
+    bool operator>=(const InstrumentedIterator& other) const { return !( *this < other ); }
+
+    decltype( auto ) operator*() const
+    {
+        count( m_counts->dereferences );
+        return *m_iterator;
+    }
+
+    decltype( auto ) operator[](difference_type n) const
+    {
+        count( m_counts->dereferences );
+        return m_iterator[ n ];
+    }
+
+private:
+    static void count( OperationCounts::counter_t& counter )
+    {
+        counter.fetch_add( 1, std::memory_order_relaxed );
+    }
+
+private:
+    iterator_t          m_iterator;
+    OperationCounts*    m_counts;
+};
+
+//----------------------------------------------------------------
+template<typename iterator_t>
+using InstrumentedRange = Range<InstrumentedIterator<iterator_t>>;
+
+//----------------------------------------------------------------
+// Counts the operations on the range under the label, independent of whether SHAKE_INSTRUMENTATION is defined.
+// Ranges that are not wrapped are not affected.
+template<typename range_t>
+InstrumentedRange<typename range_t::iterator> instrumented
+(
+    range_t             input_range,
+    const std::string&  label
+)
+{
+    auto& counts = InstrumentationRegistry::instance().counts( label );
+    return Range
+    {
+        InstrumentedIterator { std::begin( input_range ), counts },
+        InstrumentedIterator { std::end  ( input_range ), counts }
+    };
+}
+
+} // namespace shake
+
+#endif // INSTRUMENTED_RANGE_HPP
@@ -0,0 +1,268 @@
+#ifndef LINE_RANGE_HPP
+#define LINE_RANGE_HPP
+
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <istream>
+#include <iterator>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+#include "instrumentation.hpp"
+#include "mapped_range.hpp"
+#include "range.hpp"
+
+namespace shake {
+
+//----------------------------------------------------------------
+// Iterates over the lines of a buffer that is completely in memory,
+// and exposes them as string views into that buffer, without the newline character.
+// Newlines are found using std::memchr, which standard libraries implement with vector instructions.
+// A final newline does not start an extra empty line.
+// Optionally shares ownership of a mapped file, so that the buffer outlives the iterators.
+class LineIterator
+{
+public:
+    // iterator traits
+    using iterator_category = std::forward_iterator_tag;
+    using value_type        = std::string_view;
+    using difference_type   = std::ptrdiff_t;
+    using pointer           = const std::string_view*;
+    using reference         = std::string_view;
+
+public:
+    LineIterator
+    (
+        const char*                         line_begin,
+        const char*                         data_end,
+        std::shared_ptr<const MappedFile>   file = nullptr
+    )
+        : m_line_begin  { line_begin }
+        , m_line_end    { find_line_end( line_begin, data_end ) }
+        , m_data_end    { data_end }
+        , m_file        { std::move( file ) }
+    { }
+
+    const char* get_internal_iterator() const { return m_line_begin; }
+
+    LineIterator& operator++()
+    {
+        SHAKE_COUNT_OPERATION( LineIterator, "LineIterator", increments );
+        m_line_begin    = ( m_line_end == m_data_end ) ? m_data_end : m_line_end + 1;
+        m_line_end      = find_line_end( m_line_begin, m_data_end );
+        return *this;
+    }
+
+    LineIterator operator++(int) { LineIterator result = *this; ++(*this); return result; }
+
+    bool operator==( const LineIterator& other ) const { SHAKE_COUNT_OPERATION( LineIterator, "LineIterator", comparisons ); return get_internal_iterator() == other.get_internal_iterator(); }
+    bool operator!=( const LineIterator& other ) const { return !( *this == other ); }
+
+    std::string_view operator*() const
+    {
+        SHAKE_COUNT_OPERATION( LineIterator, "LineIterator", dereferences );
+        return { m_line_begin, static_cast<std::size_t>( m_line_end - m_line_begin ) };
+    }
+
+private:
+    static const char* find_line_end( const char* begin, const char* end )
+    {
+        // an empty buffer can have a null data pointer, which memchr does not accept even for a size of zero
+        if ( begin == end )
+        {
+            return end;
+        }
+        const auto newline = static_cast<const char*>( std::memchr( begin, '\n', static_cast<std::size_t>( end - begin ) ) );
+        return newline != nullptr ? newline : end;
+    }
+
+private:
+    const char*                         m_line_begin;
+    const char*                         m_line_end;
+    const char*                         m_data_end;
+    std::shared_ptr<const MappedFile>   m_file;
+    SHAKE_COUNT_COPIES( LineIterator, "LineIterator" );
+};
+
+//----------------------------------------------------------------
+using LineRange = Range<LineIterator>;
+
+//----------------------------------------------------------------
+// The buffer is not copied, so it should outlive the range and the string views it produces.
+inline LineRange lines
+(
+    std::string_view buffer
+)
+{
+    const auto data_end = buffer.data() + buffer.size();
+    return Range
+    {
+        LineIterator { buffer.data(),   data_end },
+        LineIterator { data_end,        data_end }
+    };
+}
+
+//----------------------------------------------------------------
+// Maps the file into memory, and iterates over its lines.
+// The mapping stays alive for as long as any iterator over it exists,
+// but the string views are only valid for as long as the iterators are.
+inline LineRange file_lines
+(
+    const std::filesystem::path&    path,
+    MappedAdvice                    advice = MappedAdvice::sequential
+)
+{
+    const auto file     = std::make_shared<const MappedFile>( path, advice );
+    const auto data     = file->view();
+    const auto data_end = data.data() + data.size();
+    return Range
+    {
+        LineIterator { data.data(), data_end, file },
+        LineIterator { data_end,    data_end, file }
+    };
+}
+
+//----------------------------------------------------------------
+// The state of reading lines from a stream, shared by all copies of a StreamLineIterator.
+// Only a bounded buffer is kept in memory. It only grows when a single line does not fit in it.
+class StreamLineBuffer
+{
+public:
+    StreamLineBuffer
+    (
+        std::istream&   stream,
+        std::size_t     buffer_size
+    )
+        : m_stream  { stream }
+        , m_buffer  ( buffer_size > 0 ? buffer_size : 1 )
+    {
+        advance();
+    }
+
+    bool                is_done()   const { return m_is_done; }
+    std::string_view    line()      const { return { m_buffer.data() + m_line_begin, m_line_end - m_line_begin }; }
+
+    // Finds the next line, reading from the stream whenever the buffer holds no complete line.
+    void advance()
+    {
+        m_line_begin = m_next_line_begin;
+        auto scan_begin = m_line_begin;
+        while ( true )
+        {
+            const auto newline = std::memchr( m_buffer.data() + scan_begin, '\n', m_filled - scan_begin );
+            if ( newline != nullptr )
+            {
+                m_line_end          = static_cast<std::size_t>( static_cast<const char*>( newline ) - m_buffer.data() );
+                m_next_line_begin   = m_line_end + 1;
+                return;
+            }
+            if ( m_is_stream_exhausted )
+            {
+                // the last line might not end with a newline
+                m_line_end          = m_filled;
+                m_next_line_begin   = m_filled;
+                m_is_done           = ( m_line_begin == m_filled );
+                return;
+            }
+            scan_begin = refill();
+        }
+    }
+
+private:
+    // Moves the partial line to the front of the buffer and reads more data behind it.
+    // Returns the position from where to continue scanning for a newline.
+    std::size_t refill()
+    {
+        const auto partial_size = m_filled - m_line_begin;
+        std::memmove( m_buffer.data(), m_buffer.data() + m_line_begin, partial_size );
+        m_line_begin    = 0;
+        m_filled        = partial_size;
+        if ( m_filled == m_buffer.size() )
+        {
+            m_buffer.resize( m_buffer.size() * 2 );
+        }
+
+        m_stream.read( m_buffer.data() + m_filled, static_cast<std::streamsize>( m_buffer.size() - m_filled ) );
+        const auto n_read = static_cast<std::size_t>( m_stream.gcount() );
+        m_filled += n_read;
+        m_is_stream_exhausted = ( n_read == 0 );
+        return partial_size;
+    }
+
+private:
+    std::istream&       m_stream;
+    std::vector<char>   m_buffer;
+    std::size_t         m_filled                = 0;
+    std::size_t         m_line_begin            = 0;
+    std::size_t         m_line_end              = 0;
+    std::size_t         m_next_line_begin       = 0;
+    bool                m_is_stream_exhausted   = false;
+    bool                m_is_done               = false;
+};
+
+//----------------------------------------------------------------
+// Iterates over the lines of a stream that does not need to fit in memory.
+// This is a single pass input iterator: all copies share the same buffer,
+// and a string view is only valid until the next increment.
+class StreamLineIterator
+{
+public:
+    // iterator traits
+    using iterator_category = std::input_iterator_tag;
+    using value_type        = std::string_view;
+    using difference_type   = std::ptrdiff_t;
+    using pointer           = const std::string_view*;
+    using reference         = std::string_view;
+
+public:
+    // A default constructed iterator is the end iterator
+    StreamLineIterator() = default;
+
+    explicit
+    StreamLineIterator( std::shared_ptr<StreamLineBuffer> buffer )
+        : m_buffer { std::move( buffer ) }
+    { }
+
+    bool is_done() const { return m_buffer == nullptr || m_buffer->is_done(); }
+
+    StreamLineIterator&  operator++()       { SHAKE_COUNT_OPERATION( StreamLineIterator, "StreamLineIterator", increments ); m_buffer->advance(); return *this; }
+    StreamLineIterator   operator++(int)    { StreamLineIterator result = *this; ++(*this); return result; }
+
+    bool operator==( const StreamLineIterator& other ) const { SHAKE_COUNT_OPERATION( StreamLineIterator, "StreamLineIterator", comparisons ); return is_done() == other.is_done(); }
+    bool operator!=( const StreamLineIterator& other ) const { return !( *this == other ); }
+
+    std::string_view operator*() const
+    {
+        SHAKE_COUNT_OPERATION( StreamLineIterator, "StreamLineIterator", dereferences );
+        return m_buffer->line();
+    }
+
+private:
+    std::shared_ptr<StreamLineBuffer> m_buffer;
+    SHAKE_COUNT_COPIES( StreamLineIterator, "StreamLineIterator" );
+};
+
+//----------------------------------------------------------------
+using StreamLineRange = Range<StreamLineIterator>;
+
+//----------------------------------------------------------------
+// Reads the stream in chunks of buffer_size bytes while iterating.
+// The stream should outlive the range.
+inline StreamLineRange lines
+(
+    std::istream&   stream,
+    std::size_t     buffer_size = std::size_t { 1 } << 16
+)
+{
+    return Range
+    {
+        StreamLineIterator { std::make_shared<StreamLineBuffer>( stream, buffer_size ) },
+        StreamLineIterator { }
+    };
+}
+
+} // namespace shake
+
+#endif // LINE_RANGE_HPP
@@ -1,6 +1,15 @@
+#include <string_view>
+
+#include "allocation_hooks.hpp"
+#include "benchmarks.hpp"
 #include "unit_tests.hpp"
 
-int main() 
+int main( int argc, char** argv )
 {
+    if ( argc > 1 && std::string_view { argv[ 1 ] } == "--benchmark" )
+    {
+        shake::benchmarks::run();
+        return 0;
+    }
     shake::unit_tests::run();
-}
\ No newline at end of file
+}
@@ -0,0 +1,271 @@
+#ifndef MAPPED_RANGE_HPP
+#define MAPPED_RANGE_HPP
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <iterator>
+#include <memory>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "instrumentation.hpp"
+#include "range.hpp"
+
+namespace shake {
+
+//----------------------------------------------------------------
+// Hints passed on to the kernel about how a mapping will be accessed.
+// They can be combined using |.
+// release_behind is not a kernel hint, but makes iterators over the mapping
+// hand back pages they have already passed, so that resident memory stays bounded.
+enum class MappedAdvice : unsigned
+{
+    normal          = 0,
+    sequential      = 1 << 0,
+    willneed        = 1 << 1,
+    huge_pages      = 1 << 2,
+    release_behind  = 1 << 3,
+};
+
+inline MappedAdvice operator|( MappedAdvice lhs, MappedAdvice rhs )
+{
+    return static_cast<MappedAdvice>( static_cast<unsigned>( lhs ) | static_cast<unsigned>( rhs ) );
+}
+
+inline bool has_advice( MappedAdvice advice, MappedAdvice flag )
+{
+    return ( static_cast<unsigned>( advice ) & static_cast<unsigned>( flag ) ) != 0;
+}
+
+//----------------------------------------------------------------
+// Owns a read-only memory mapping of a whole file.
+// The mapping is released when the object is destroyed, so iterators over it
+// share ownership through a std::shared_ptr instead of copying the data.
+class MappedFile
+{
+public:
+    explicit
+    MappedFile
+    (
+        const std::filesystem::path&    path,
+        MappedAdvice                    advice = MappedAdvice::normal
+    )
+        : m_advice { advice }
+    {
+        const int file_descriptor = ::open( path.c_str(), O_RDONLY | O_CLOEXEC );
+        if ( file_descriptor < 0 )
+        {
+            throw std::system_error( errno, std::generic_category(), "shake: could not open " + path.string() );
+        }
+
+        struct stat file_status {};
+        if ( ::fstat( file_descriptor, &file_status ) != 0 )
+        {
+            const int error = errno;
+            ::close( file_descriptor );
+            throw std::system_error( error, std::generic_category(), "shake: could not stat " + path.string() );
+        }
+        m_size = static_cast<std::size_t>( file_status.st_size );
+
+        // mmap refuses zero length mappings, an empty file simply maps to no data
+        if ( m_size > 0 )
+        {
+            void* data = ::mmap( nullptr, m_size, PROT_READ, MAP_PRIVATE, file_descriptor, 0 );
+            if ( data == MAP_FAILED )
+            {
+                const int error = errno;
+                ::close( file_descriptor );
+                throw std::system_error( error, std::generic_category(), "shake: could not map " + path.string() );
+            }
+            m_data = static_cast<const std::byte*>( data );
+        }
+        // the mapping stays valid after the descriptor is closed
+        ::close( file_descriptor );
+
+        advise( advice );
+    }
+
+    MappedFile( const MappedFile& ) = delete;
+    MappedFile& operator=( const MappedFile& ) = delete;
+
+    ~MappedFile()
+    {
+        if ( m_data != nullptr )
+        {
+            ::munmap( const_cast<std::byte*>( m_data ), m_size );
+        }
+    }
+
+    const std::byte*    data()      const { return m_data;   }
+    std::size_t         size()      const { return m_size;   }
+    MappedAdvice        advice()    const { return m_advice; }
+
+    std::string_view view() const
+    {
+        return { reinterpret_cast<const char*>( m_data ), m_size };
+    }
+
+    // Advice is only a hint, so failures (e.g. no transparent huge page support) are ignored.
+    void advise( MappedAdvice advice ) const
+    {
+        if ( m_data == nullptr )
+        {
+            return;
+        }
+        void* data = const_cast<std::byte*>( m_data );
+        if ( has_advice( advice, MappedAdvice::sequential ) ) { ::madvise( data, m_size, MADV_SEQUENTIAL ); }
+        if ( has_advice( advice, MappedAdvice::willneed   ) ) { ::madvise( data, m_size, MADV_WILLNEED   ); }
+#ifdef MADV_HUGEPAGE
+        if ( has_advice( advice, MappedAdvice::huge_pages ) ) { ::madvise( data, m_size, MADV_HUGEPAGE   ); }
+#endif
+    }
+
+    // Drops the whole pages in [begin, end) from memory.
+    // The mapping is private and read-only, so they are simply read from the file again if touched later.
+    void release( const std::byte* begin, const std::byte* end ) const
+    {
+        const auto page_size    = static_cast<std::uintptr_t>( ::sysconf( _SC_PAGESIZE ) );
+        const auto first_page   = ( reinterpret_cast<std::uintptr_t>( begin ) + page_size - 1 ) / page_size * page_size;
+        const auto last_page    = reinterpret_cast<std::uintptr_t>( end ) / page_size * page_size;
+        if ( first_page < last_page )
+        {
+            ::madvise( reinterpret_cast<void*>( first_page ), last_page - first_page, MADV_DONTNEED );
+        }
+    }
+
+private:
+    const std::byte*    m_data      = nullptr;
+    std::size_t         m_size      = 0;
+    MappedAdvice        m_advice    = MappedAdvice::normal;
+};
+
+//----------------------------------------------------------------
+// Iterates over the fixed-size records of a memory mapped file, in place.
+// Nothing is read until the records are dereferenced, and the file is never copied.
+// The iterator is truly random-access, so it can be combined, stepped and split like any pointer.
+template<typename T>
+class MappedRecordIterator
+{
+    static_assert( std::is_trivially_copyable_v<T>, "records can only be mapped onto trivially copyable types" );
+
+public:
+    // iterator traits
+    using iterator_category = std::random_access_iterator_tag;
+    using iterator_concept  = std::contiguous_iterator_tag;
+    using value_type        = T;
+    using difference_type   = std::ptrdiff_t;
+    using pointer           = const T*;
+    using reference         = const T&;
+
+    // Pages are handed back in chunks, so that the madvise call is amortized over many increments
+    static constexpr std::size_t release_chunk_size = std::size_t { 1 } << 22;
+
+public:
+    MappedRecordIterator() = default;
+
+    MappedRecordIterator
+    (
+        std::shared_ptr<const MappedFile>   file,
+        const T*                            current
+    )
+        : m_file            { std::move( file ) }
+        , m_current         { current }
+        , m_released_until  { reinterpret_cast<const std::byte*>( current ) }
+        , m_release_behind  { m_file != nullptr && has_advice( m_file->advice(), MappedAdvice::release_behind ) }
+    { }
+
+    const T* get_internal_iterator() const { return m_current; }
+
+    MappedRecordIterator& operator++()
+    {
+        SHAKE_COUNT_OPERATION( MappedRecordIterator, "MappedRecordIterator", increments );
+        ++m_current;
+        if ( m_release_behind )
+        {
+            release_behind();
+        }
+        return *this;
+    }
+
+    MappedRecordIterator operator++(int) { MappedRecordIterator result = *this; ++(*this); return result; }
+
+    // Jumping starts releasing from the new position, so that pages that were never passed are not handed back.
+    MappedRecordIterator& operator--()                      { return *this -= 1; }
+    MappedRecordIterator  operator--(int)                   { MappedRecordIterator result = *this; --(*this); return result; }
+    MappedRecordIterator& operator+=( difference_type n )   { m_current += n; m_released_until = reinterpret_cast<const std::byte*>( m_current ); return *this; }
+    MappedRecordIterator& operator-=( difference_type n )   { return *this += -n; }
+
+    MappedRecordIterator operator+( difference_type n ) const { MappedRecordIterator result = *this; return result += n; }
+    MappedRecordIterator operator-( difference_type n ) const { MappedRecordIterator result = *this; return result -= n; }
+    friend MappedRecordIterator operator+( difference_type n, const MappedRecordIterator& it ) { return it + n; }
+
+    difference_type operator-( const MappedRecordIterator& other ) const { return m_current - other.m_current; }
+
+    bool operator==( const MappedRecordIterator& other ) const { SHAKE_COUNT_OPERATION( MappedRecordIterator, "MappedRecordIterator", comparisons ); return m_current == other.m_current; }
+    bool operator!=( const MappedRecordIterator& other ) const { return m_current != other.m_current; }
+    bool operator< ( const MappedRecordIterator& other ) const { return m_current <  other.m_current; }
+    bool operator> ( const MappedRecordIterator& other ) const { return m_current >  other.m_current; }
+    bool operator<=( const MappedRecordIterator& other ) const { return m_current <= other.m_current; }
+    bool operator>=( const MappedRecordIterator& other ) const { return m_current >= other.m_current; }
+
+    const T& operator*()                        const { SHAKE_COUNT_OPERATION( MappedRecordIterator, "MappedRecordIterator", dereferences ); return *m_current; }
+    const T* operator->()                       const { return m_current; }
+    const T& operator[]( difference_type n )    const { return m_current[ n ]; }
+
+private:
+    void release_behind()
+    {
+        const auto current = reinterpret_cast<const std::byte*>( m_current );
+        if ( static_cast<std::size_t>( current - m_released_until ) >= release_chunk_size )
+        {
+            m_file->release( m_released_until, current );
+            m_released_until = current;
+        }
+    }
+
+private:
+    std::shared_ptr<const MappedFile>   m_file;
+    const T*                            m_current           = nullptr;
+    const std::byte*                    m_released_until    = nullptr;
+    // cached from the file, so that incrementing does not have to load it through the shared pointer
+    bool                                m_release_behind    = false;
+    SHAKE_COUNT_COPIES( MappedRecordIterator, "MappedRecordIterator" );
+};
+
+//----------------------------------------------------------------
+template<typename T>
+using MappedRecordRange = Range<MappedRecordIterator<T>>;
+
+//----------------------------------------------------------------
+// Maps a file of back-to-back records of type T, and returns a const range over them.
+// Trailing bytes that do not form a complete record are ignored.
+// The mapping stays alive for as long as any iterator over it exists.
+template<typename T>
+MappedRecordRange<T> mapped_records
+(
+    const std::filesystem::path&    path,
+    MappedAdvice                    advice = MappedAdvice::sequential
+)
+{
+    const auto file     = std::make_shared<const MappedFile>( path, advice );
+    const auto begin    = reinterpret_cast<const T*>( file->data() );
+    const auto n_records = file->size() / sizeof( T );
+
+    return Range
+    {
+        MappedRecordIterator<T> { file, begin             },
+        MappedRecordIterator<T> { file, begin + n_records }
+    };
+}
+
+} // namespace shake
+
+#endif // MAPPED_RANGE_HPP
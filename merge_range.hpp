@@ -0,0 +1,238 @@
+#ifndef MERGE_RANGE_HPP
+#define MERGE_RANGE_HPP
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "instrumentation.hpp"
+#include "range.hpp"
+
+namespace shake {
+
+//----------------------------------------------------------------
+// The state of a k-way merge of sorted ranges, as a tournament tree of losers.
+// The leaves are the ranges, and each inner node remembers the range that lost the match at that node,
+// while the winner of the whole tree is the range with the next element.
+// Advancing the winner only replays the matches on the path from its leaf to the root,
+// so each element costs log2( k ) comparisons, and the winner of each match is selected without a branch.
+// Stable merges break ties by the position of the range, so equal elements come out in the order of their ranges.
+template<typename iterator_t, typename compare_t, bool is_stable>
+class LoserTree
+{
+public:
+    using reference = decltype( *std::declval<const iterator_t&>() );
+
+public:
+    LoserTree
+    (
+        const std::vector<Range<iterator_t>>&   ranges,
+        const compare_t&                        compare
+    )
+        : m_compare     { compare }
+        , m_n_leaves    { std::bit_ceil( std::max<std::size_t>( ranges.size(), 1 ) ) }
+        , m_losers      ( m_n_leaves )
+    {
+        m_iterators.reserve( ranges.size() );
+        m_end_iterators.reserve( ranges.size() );
+        for ( const auto& input_range : ranges )
+        {
+            m_iterators.push_back( std::begin( input_range ) );
+            m_end_iterators.push_back( std::end( input_range ) );
+        }
+        // the leaves beyond the ranges are padding, which are always exhausted
+        m_is_exhausted.resize( m_n_leaves, true );
+        for ( std::size_t leaf = 0; leaf < ranges.size(); ++leaf )
+        {
+            m_is_exhausted[ leaf ] = m_iterators[ leaf ] == m_end_iterators[ leaf ];
+        }
+
+        // play all matches from the leaves up, with the winners of the nodes below as players
+        auto winners = std::vector<std::size_t>( 2 * m_n_leaves );
+        for ( std::size_t leaf = 0; leaf < m_n_leaves; ++leaf )
+        {
+            winners[ m_n_leaves + leaf ] = leaf;
+        }
+        for ( auto node = m_n_leaves - 1; node > 0; --node )
+        {
+            const auto left     = winners[ 2 * node ];
+            const auto right    = winners[ 2 * node + 1 ];
+            const auto is_right_before = is_before( right, left );
+            winners[ node ]     = is_right_before ? right : left;
+            m_losers[ node ]    = is_right_before ? left : right;
+        }
+        m_winner = winners[ 1 ];
+    }
+
+    bool        is_done()   const { return m_is_exhausted[ m_winner ]; }
+    reference   current()   const { return *m_iterators[ m_winner ]; }
+
+    void advance()
+    {
+        const auto leaf = m_winner;
+        m_is_exhausted[ leaf ] = ++m_iterators[ leaf ] == m_end_iterators[ leaf ];
+
+        auto winner = leaf;
+        for ( auto node = ( m_n_leaves + leaf ) / 2; node > 0; node /= 2 )
+        {
+            const auto loser = m_losers[ node ];
+            // all ones when the loser wins this time, in which case the two swap places
+            const auto swap_mask = std::size_t { 0 } - static_cast<std::size_t>( is_before( loser, winner ) );
+            const auto difference = ( loser ^ winner ) & swap_mask;
+            m_losers[ node ]    = loser ^ difference;
+            winner              = winner ^ difference;
+        }
+        m_winner = winner;
+    }
+
+private:
+    // Whether the next element of range a comes before that of range b, where exhausted ranges come last
+    bool is_before( std::size_t a, std::size_t b ) const
+    {
+        if ( m_is_exhausted[ a ] || m_is_exhausted[ b ] )
+        {
+            return !m_is_exhausted[ a ];
+        }
+        if constexpr ( is_stable )
+        {
+            // a single comparison suffices: the element of the first range wins unless the other is strictly before it,
+            // which compares the elements of the later and the earlier range, without branching on which is which
+            const auto is_a_first = a < b;
+            const auto later    = is_a_first ? b : a;
+            const auto earlier  = is_a_first ? a : b;
+            return is_a_first != std::invoke( m_compare, *m_iterators[ later ], *m_iterators[ earlier ] );
+        }
+        else
+        {
+            return std::invoke( m_compare, *m_iterators[ a ], *m_iterators[ b ] );
+        }
+    }
+
+private:
+    compare_t                   m_compare;
+    std::size_t                 m_n_leaves;
+    std::vector<iterator_t>     m_iterators;
+    std::vector<iterator_t>     m_end_iterators;
+    std::vector<unsigned char>  m_is_exhausted;
+    // the loser of the match at each inner node, where node 1 is the root, and the children of node n are 2n and 2n + 1
+    std::vector<std::size_t>    m_losers;
+    std::size_t                 m_winner        { 0 };
+};
+
+//----------------------------------------------------------------
+// Iterates over the elements of multiple sorted ranges in sorted order.
+// This is a single pass input iterator: all copies share the same tournament tree,
+// which is built when the range is created, and consumed by iterating.
+template<typename iterator_t, typename compare_t, bool is_stable>
+class MergeIterator
+{
+public:
+    using tree_t = LoserTree<iterator_t, compare_t, is_stable>;
+
+public:
+    // iterator traits
+    using iterator_category = std::input_iterator_tag;
+    using reference         = typename tree_t::reference;
+    using value_type        = std::remove_cvref_t<reference>;
+    using difference_type   = std::ptrdiff_t;
+    using pointer           = std::add_pointer_t<reference>;
+
+public:
+    // A default constructed iterator is the end iterator
+    MergeIterator() = default;
+
+    explicit
+    MergeIterator( std::shared_ptr<tree_t> tree )
+        : m_tree { std::move( tree ) }
+    { }
+
+    bool is_done() const { return m_tree == nullptr || m_tree->is_done(); }
+
+    MergeIterator&  operator++()       { SHAKE_COUNT_OPERATION( MergeIterator, "MergeIterator", increments ); m_tree->advance(); return *this; }
+    MergeIterator   operator++(int)    { MergeIterator result = *this; ++(*this); return result; }
+
+    bool operator==( const MergeIterator& other ) const { SHAKE_COUNT_OPERATION( MergeIterator, "MergeIterator", comparisons ); return is_done() == other.is_done(); }
+    bool operator!=( const MergeIterator& other ) const { return !( *this == other ); }
+
+    reference operator*() const
+    {
+        SHAKE_COUNT_OPERATION( MergeIterator, "MergeIterator", dereferences );
+        return m_tree->current();
+    }
+
+private:
+    std::shared_ptr<tree_t> m_tree;
+    SHAKE_COUNT_COPIES( MergeIterator, "MergeIterator" );
+};
+
+//----------------------------------------------------------------
+template<typename iterator_t, typename compare_t, bool is_stable>
+using MergeRange = Range<MergeIterator<iterator_t, compare_t, is_stable>>;
+
+//----------------------------------------------------------------
+// Merges any number of ranges that are sorted by the comparison, into a single sorted range, like heapq.merge.
+// Equal elements of different ranges come out in an unspecified order.
+template<typename iterator_t, typename compare_t = std::less<>>
+MergeRange<iterator_t, compare_t, false> merge
+(
+    const std::vector<Range<iterator_t>>&   ranges,
+    const compare_t&                        compare = { }
+)
+{
+    using merge_iterator_t = MergeIterator<iterator_t, compare_t, false>;
+    return Range
+    {
+        merge_iterator_t { std::make_shared<typename merge_iterator_t::tree_t>( ranges, compare ) },
+        merge_iterator_t { }
+    };
+}
+
+// Merges a fixed number of sorted ranges of the same type, with std::less.
+template<typename iterator_t, typename... IteratorArgs>
+MergeRange<iterator_t, std::less<>, false> merge
+(
+    const Range<iterator_t>&            first_range,
+    const Range<IteratorArgs>&...       other_ranges
+)
+{
+    static_assert( ( std::is_same_v<iterator_t, IteratorArgs> && ... ), "merged ranges should be of the same type" );
+    return merge( std::vector<Range<iterator_t>> { first_range, other_ranges... } );
+}
+
+//----------------------------------------------------------------
+// Like merge, but equal elements come out in the order of their ranges, and in their order within a range.
+template<typename iterator_t, typename compare_t = std::less<>>
+MergeRange<iterator_t, compare_t, true> stable_merge
+(
+    const std::vector<Range<iterator_t>>&   ranges,
+    const compare_t&                        compare = { }
+)
+{
+    using merge_iterator_t = MergeIterator<iterator_t, compare_t, true>;
+    return Range
+    {
+        merge_iterator_t { std::make_shared<typename merge_iterator_t::tree_t>( ranges, compare ) },
+        merge_iterator_t { }
+    };
+}
+
+template<typename iterator_t, typename... IteratorArgs>
+MergeRange<iterator_t, std::less<>, true> stable_merge
+(
+    const Range<iterator_t>&            first_range,
+    const Range<IteratorArgs>&...       other_ranges
+)
+{
+    static_assert( ( std::is_same_v<iterator_t, IteratorArgs> && ... ), "merged ranges should be of the same type" );
+    return stable_merge( std::vector<Range<iterator_t>> { first_range, other_ranges... } );
+}
+
+} // namespace shake
+
+#endif // MERGE_RANGE_HPP
@@ -0,0 +1,173 @@
+#ifndef PAIR_RANGE_HPP
+#define PAIR_RANGE_HPP
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <tuple>
+#include <type_traits>
+
+#include "index_range.hpp"
+#include "instrumentation.hpp"
+#include "range.hpp"
+
+namespace shake {
+
+//----------------------------------------------------------------
+// Iterates over all pairs of elements of a random-access range, of which the first comes before the second,
+// like the nested loops for i in range(n): for j in range(i + 1, n).
+// The pairs are ordered by the first and then the second element, and ranked from 0 to n * ( n - 1 ) / 2.
+// Incrementing only moves the second element, until it wraps around to the first element after the next one.
+// Jumping to a rank solves the quadratic equation for the first element, so it takes constant time,
+// which makes the range random-access over the triangular index space, so that it can be split into parts with equally many pairs.
+template<typename iterator_t>
+class PairIterator
+{
+private:
+    using element_t = decltype( std::declval<const iterator_t&>()[ 0 ] );
+
+public:
+    // iterator traits
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type        = std::tuple<element_t, element_t>;
+    using difference_type   = std::ptrdiff_t;
+    using pointer           = value_type*;
+    using reference         = value_type&;
+
+public:
+    PairIterator
+    (
+        const iterator_t&   begin_iterator,
+        std::uint64_t       n_elements,
+        std::uint64_t       rank
+    )
+        : m_begin_iterator  { begin_iterator }
+        , m_n_elements      { n_elements }
+    {
+        move_to( rank );
+    }
+
+    std::uint64_t get_first_index()     const { return m_first; }
+    std::uint64_t get_second_index()    const { return m_second; }
+    std::uint64_t get_rank()            const { return m_rank; }
+
+    PairIterator& operator++()
+    {
+        SHAKE_COUNT_OPERATION( PairIterator, "PairIterator", increments );
+        ++m_rank;
+        if ( ++m_second == m_n_elements )
+        {
+            ++m_first;
+            m_second = m_first + 1;
+        }
+        return *this;
+    }
+
+    PairIterator operator++(int) { PairIterator result = *this; ++(*this); return result; }
+
+    PairIterator&   operator--()                        { move_to( m_rank - 1 ); return *this; }
+    PairIterator    operator--(int)                     { PairIterator result = *this; --(*this); return result; }
+    PairIterator&   operator+=(difference_type n)       { move_to( m_rank + static_cast<std::uint64_t>( n ) ); return *this; }
+    PairIterator&   operator-=(difference_type n)       { return *this += -n; }
+    PairIterator    operator+ (difference_type n) const { PairIterator result = *this; return result += n; }
+    PairIterator    operator- (difference_type n) const { PairIterator result = *this; return result -= n; }
+    difference_type operator- (const PairIterator& other) const { return static_cast<difference_type>( m_rank - other.m_rank ); }
+
+    bool operator==(const PairIterator& other) const { SHAKE_COUNT_OPERATION( PairIterator, "PairIterator", comparisons ); return m_rank == other.m_rank; }
+    bool operator!=(const PairIterator& other) const { return !(*this == other); }
+    bool operator< (const PairIterator& other) const { return m_rank < other.m_rank; }
+
+    value_type operator*() const
+    {
+        SHAKE_COUNT_OPERATION( PairIterator, "PairIterator", dereferences );
+        return value_type
+        (
+            m_begin_iterator[ static_cast<difference_type>( m_first ) ],
+            m_begin_iterator[ static_cast<difference_type>( m_second ) ]
+        );
+    }
+
+    value_type operator[](difference_type n) const { return *( *this + n ); }
+
+private:
+    // The number of pairs of which the first element comes before the element with the index
+    std::uint64_t n_pairs_before( std::uint64_t first ) const
+    {
+        return first * m_n_elements - first * ( first + 1 ) / 2;
+    }
+
+    // The first index is the largest one with at most rank pairs before it.
+    // Solving n_pairs_before( first ) <= rank in floating point might be off by one for large ranges, which the loops correct.
+    void move_to( std::uint64_t rank )
+    {
+        m_rank = rank;
+        const auto n = static_cast<long double>( m_n_elements );
+        const auto discriminant = ( 2 * n - 1 ) * ( 2 * n - 1 ) - 8 * static_cast<long double>( rank );
+        auto first = static_cast<std::uint64_t>( std::max<long double>( std::floor( ( 2 * n - 1 - std::sqrt( std::max<long double>( discriminant, 0 ) ) ) / 2 ), 0 ) );
+        while ( first > 0 && n_pairs_before( first ) > rank )
+        {
+            --first;
+        }
+        while ( first + 1 < m_n_elements && n_pairs_before( first + 1 ) <= rank )
+        {
+            ++first;
+        }
+        m_first     = first;
+        m_second    = first + 1 + ( rank - n_pairs_before( first ) );
+    }
+
+private:
+    iterator_t      m_begin_iterator;
+    std::uint64_t   m_n_elements;
+    std::uint64_t   m_rank;
+    std::uint64_t   m_first;
+    std::uint64_t   m_second;
+    SHAKE_COUNT_COPIES( PairIterator, "PairIterator" );
+};
+
+//----------------------------------------------------------------
+template<typename iterator_t>
+using PairRange = Range<PairIterator<iterator_t>>;
+
+//----------------------------------------------------------------
+// All pairs of elements of a random-access range, of which the first comes before the second.
+// The elements are referred to like the range refers to them, so they can be modified through non-const ranges.
+// The number of elements should be smaller than 2^32, so that the number of pairs fits in 64 bits.
+template<typename range_t>
+PairRange<typename range_t::iterator> pairs
+(
+    range_t input_range
+)
+{
+    using iterator_t = typename range_t::iterator;
+    static_assert
+    (
+        std::is_base_of_v<std::random_access_iterator_tag, typename std::iterator_traits<iterator_t>::iterator_category>,
+        "only the elements of random-access ranges can be paired"
+    );
+
+    const auto begin_iterator   = std::begin( input_range );
+    const auto n_elements       = static_cast<std::uint64_t>( std::end( input_range ) - begin_iterator );
+    const auto n_pairs          = n_elements < 2 ? 0 : n_elements * ( n_elements - 1 ) / 2;
+
+    return Range
+    {
+        PairIterator<iterator_t> { begin_iterator, n_elements, 0       },
+        PairIterator<iterator_t> { begin_iterator, n_elements, n_pairs }
+    };
+}
+
+//----------------------------------------------------------------
+// All pairs of indices i < j below the number of elements
+inline PairRange<IndexIterator> pairs
+(
+    std::size_t n_elements
+)
+{
+    return pairs( range( n_elements ) );
+}
+
+} // namespace shake
+
+#endif // PAIR_RANGE_HPP
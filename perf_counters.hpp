@@ -0,0 +1,143 @@
+#ifndef PERF_COUNTERS_HPP
+#define PERF_COUNTERS_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace shake {
+
+//----------------------------------------------------------------
+// The hardware events that are counted, in the order of PerfCounterValues.
+enum class PerfEvent : std::size_t
+{
+    cycles,
+    instructions,
+    branch_misses,
+    l1d_misses,
+    llc_misses,
+    count
+};
+
+//----------------------------------------------------------------
+// Counter values read after stopping, empty for counters that could not be opened.
+using PerfCounterValues = std::array<std::optional<std::uint64_t>, static_cast<std::size_t>( PerfEvent::count )>;
+
+//----------------------------------------------------------------
+// Counts hardware events of the calling thread using the Linux perf_event_open interface.
+// Each counter is opened separately, so that a single unsupported event does not disable the others.
+// Counters can not be opened in many containers and virtual machines (see /proc/sys/kernel/perf_event_paranoid),
+// in which case they simply report no values, and benchmarks fall back to wall-clock time.
+class PerfCounters
+{
+public:
+    PerfCounters()
+    {
+        const auto cache_miss = []( std::uint64_t cache ) -> std::uint64_t
+        {
+            return cache | ( PERF_COUNT_HW_CACHE_OP_READ << 8 ) | ( PERF_COUNT_HW_CACHE_RESULT_MISS << 16 );
+        };
+        m_file_descriptors =
+        {
+            open( PERF_TYPE_HARDWARE,   PERF_COUNT_HW_CPU_CYCLES ),
+            open( PERF_TYPE_HARDWARE,   PERF_COUNT_HW_INSTRUCTIONS ),
+            open( PERF_TYPE_HARDWARE,   PERF_COUNT_HW_BRANCH_MISSES ),
+            open( PERF_TYPE_HW_CACHE,   cache_miss( PERF_COUNT_HW_CACHE_L1D ) ),
+            open( PERF_TYPE_HW_CACHE,   cache_miss( PERF_COUNT_HW_CACHE_LL ) ),
+        };
+    }
+
+    PerfCounters( const PerfCounters& ) = delete;
+    PerfCounters& operator=( const PerfCounters& ) = delete;
+
+    ~PerfCounters()
+    {
+        for ( const auto file_descriptor : m_file_descriptors )
+        {
+            if ( file_descriptor >= 0 )
+            {
+                ::close( file_descriptor );
+            }
+        }
+    }
+
+    bool is_available() const
+    {
+        for ( const auto file_descriptor : m_file_descriptors )
+        {
+            if ( file_descriptor >= 0 )
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void start()
+    {
+        for ( const auto file_descriptor : m_file_descriptors )
+        {
+            if ( file_descriptor >= 0 )
+            {
+                ::ioctl( file_descriptor, PERF_EVENT_IOC_RESET, 0 );
+                ::ioctl( file_descriptor, PERF_EVENT_IOC_ENABLE, 0 );
+            }
+        }
+    }
+
+    void stop()
+    {
+        for ( const auto file_descriptor : m_file_descriptors )
+        {
+            if ( file_descriptor >= 0 )
+            {
+                ::ioctl( file_descriptor, PERF_EVENT_IOC_DISABLE, 0 );
+            }
+        }
+    }
+
+    // When there are more counters than hardware registers, the kernel multiplexes them,
+    // so values are scaled up by the fraction of time each counter was actually running.
+    PerfCounterValues read() const
+    {
+        auto values = PerfCounterValues { };
+        for ( std::size_t i = 0; i < m_file_descriptors.size(); ++i )
+        {
+            struct { std::uint64_t value, time_enabled, time_running; } data {};
+            if ( m_file_descriptors[ i ] >= 0 && ::read( m_file_descriptors[ i ], &data, sizeof( data ) ) == sizeof( data ) && data.time_running > 0 )
+            {
+                const auto scale = static_cast<double>( data.time_enabled ) / static_cast<double>( data.time_running );
+                values[ i ] = static_cast<std::uint64_t>( static_cast<double>( data.value ) * scale );
+            }
+        }
+        return values;
+    }
+
+private:
+    static int open( std::uint32_t type, std::uint64_t config )
+    {
+        auto attributes = perf_event_attr { };
+        attributes.size             = sizeof( attributes );
+        attributes.type             = type;
+        attributes.config           = config;
+        attributes.disabled         = 1;
+        attributes.exclude_kernel   = 1;
+        attributes.exclude_hv       = 1;
+        attributes.read_format      = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        // measure the calling thread, on any cpu
+        return static_cast<int>( ::syscall( SYS_perf_event_open, &attributes, 0, -1, -1, 0 ) );
+    }
+
+private:
+    std::array<int, static_cast<std::size_t>( PerfEvent::count )> m_file_descriptors;
+};
+
+} // namespace shake
+
+#endif // PERF_COUNTERS_HPP
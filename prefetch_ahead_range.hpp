@@ -0,0 +1,275 @@
+#ifndef PREFETCH_AHEAD_RANGE_HPP
+#define PREFETCH_AHEAD_RANGE_HPP
+
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <tuple>
+#include <type_traits>
+
+#include "instrumentation.hpp"
+#include "range.hpp"
+
+namespace shake {
+
+namespace prefetch_detail {
+
+//----------------------------------------------------------------
+// Hints the cpu to start loading the cache line of the address, without waiting for it.
+inline void prefetch_for_read( const void* address )
+{
+#if defined( __GNUC__ ) || defined( __clang__ )
+    __builtin_prefetch( address, 0, 3 );
+#else
+    static_cast<void>( address );
+#endif
+}
+
+template<typename T>
+struct is_tuple : std::false_type { };
+
+template<typename... Ts>
+struct is_tuple<std::tuple<Ts...>> : std::true_type { };
+
+//----------------------------------------------------------------
+// Prefetches the element an iterator refers to, without computing anything.
+// Iterators that produce references are prefetched directly. Iterators that produce values,
+// like the transform iterator, are unwrapped to the iterators they wrap, so that the underlying elements are prefetched,
+// without invoking any function. The combined iterators of a combine iterator are all prefetched.
+template<typename iterator_t>
+void prefetch_element( const iterator_t& it )
+{
+    if constexpr ( std::is_lvalue_reference_v<decltype( *it )> )
+    {
+        prefetch_for_read( std::addressof( *it ) );
+    }
+    else if constexpr ( requires { it.get_internal_iterator(); } )
+    {
+        using internal_t = std::remove_cvref_t<decltype( it.get_internal_iterator() )>;
+        if constexpr ( is_tuple<internal_t>::value )
+        {
+            std::apply( []( const auto&... internal ) { ( prefetch_element( internal ), ... ); }, it.get_internal_iterator() );
+        }
+        else if constexpr ( requires ( const internal_t& internal ) { *internal; } )
+        {
+            prefetch_element( it.get_internal_iterator() );
+        }
+    }
+}
+
+} // namespace prefetch_detail
+
+//----------------------------------------------------------------
+// How many elements ahead of the consumer are prefetched by default.
+// It should cover the memory latency divided by the time spent per element, and can be tuned per range.
+constexpr std::size_t default_prefetch_distance = 32;
+
+//----------------------------------------------------------------
+// Iterates over a range, while a lookahead iterator walks a fixed distance ahead and prefetches the elements it passes.
+// This hides the memory latency of ranges that find the addresses of their elements without loading them,
+// like an indirect range over a shuffled order, whose elements are scattered so that the hardware prefetcher can not predict them.
+// It does not help node-based containers like std::map, since the lookahead has to load each node to find the next one,
+// so the consumer already finds the nodes in cache without any prefetch.
+template<typename iterator_t>
+class PrefetchAheadIterator
+{
+public:
+    // iterator traits
+    // the lookahead iterator walks the same range again, so the range should be at least a forward range
+    using iterator_category = std::forward_iterator_tag;
+    using value_type        = typename std::iterator_traits<iterator_t>::value_type;
+    using difference_type   = typename std::iterator_traits<iterator_t>::difference_type;
+    using pointer           = typename std::iterator_traits<iterator_t>::pointer;
+    using reference         = typename std::iterator_traits<iterator_t>::reference;
+
+public:
+    PrefetchAheadIterator
+    (
+        const iterator_t&   iterator,
+        const iterator_t&   lookahead_iterator,
+        const iterator_t&   end_iterator
+    )
+        : m_iterator            { iterator }
+        , m_lookahead_iterator  { lookahead_iterator }
+        , m_end_iterator        { end_iterator }
+    { }
+
+    const iterator_t& get_internal_iterator() const { return m_iterator; }
+
+    PrefetchAheadIterator& operator++()
+    {
+        SHAKE_COUNT_OPERATION( PrefetchAheadIterator, "PrefetchAheadIterator", increments );
+        ++m_iterator;
+        if ( m_lookahead_iterator != m_end_iterator )
+        {
+            prefetch_detail::prefetch_element( m_lookahead_iterator );
+            ++m_lookahead_iterator;
+        }
+        return *this;
+    }
+
+    PrefetchAheadIterator operator++(int) { PrefetchAheadIterator result = *this; ++(*this); return result; }
+
+    bool operator==(const PrefetchAheadIterator& other) const { SHAKE_COUNT_OPERATION( PrefetchAheadIterator, "PrefetchAheadIterator", comparisons ); return get_internal_iterator() == other.get_internal_iterator(); }
+    bool operator!=(const PrefetchAheadIterator& other) const { return !(*this == other); }
+
+    decltype( auto ) operator*() const
+    {
+        SHAKE_COUNT_OPERATION( PrefetchAheadIterator, "PrefetchAheadIterator", dereferences );
+        return *m_iterator;
+    }
+
+private:
+    iterator_t  m_iterator;
+    iterator_t  m_lookahead_iterator;
+    iterator_t  m_end_iterator;
+    SHAKE_COUNT_COPIES( PrefetchAheadIterator, "PrefetchAheadIterator" );
+};
+
+//----------------------------------------------------------------
+template<typename iterator_t>
+using PrefetchAheadRange = Range<PrefetchAheadIterator<iterator_t>>;
+
+//----------------------------------------------------------------
+// Prefetches the elements of the range up to distance elements ahead of the loop that iterates over it.
+// Unlike the prefetch range, this does not start a thread, but only issues prefetch instructions,
+// which pays off for ranges that wait on memory rather than on computations or I/O.
+template<typename range_t>
+PrefetchAheadRange<typename range_t::iterator> prefetch_ahead
+(
+    range_t         input_range,
+    std::size_t     distance = default_prefetch_distance
+)
+{
+    using iterator_t = typename range_t::iterator;
+
+    const auto begin_iterator = std::begin( input_range );
+    const auto end_iterator   = std::end( input_range );
+
+    // prefetch the first elements up front, so the lookahead starts at the prefetch distance
+    auto lookahead_iterator = begin_iterator;
+    for ( std::size_t i = 0; i < distance && lookahead_iterator != end_iterator; ++i, ++lookahead_iterator )
+    {
+        prefetch_detail::prefetch_element( lookahead_iterator );
+    }
+
+    return Range
+    {
+        PrefetchAheadIterator<iterator_t> { begin_iterator, lookahead_iterator, end_iterator },
+        PrefetchAheadIterator<iterator_t> { end_iterator,   end_iterator,       end_iterator }
+    };
+}
+
+//----------------------------------------------------------------
+// Iterates over the elements data[ indices[ i ] ], while prefetching the elements that the indices a fixed distance ahead refer to.
+// Reading the indices ahead is cheap, because they are read sequentially,
+// while the data they refer to is spread out, which would otherwise cost a cache miss per element.
+template<typename data_iterator_t, typename index_iterator_t>
+class GatherIterator
+{
+public:
+    // iterator traits
+    using iterator_category = std::forward_iterator_tag;
+    using value_type        = typename std::iterator_traits<data_iterator_t>::value_type;
+    using difference_type   = std::ptrdiff_t;
+    using pointer           = typename std::iterator_traits<data_iterator_t>::pointer;
+    using reference         = typename std::iterator_traits<data_iterator_t>::reference;
+
+public:
+    GatherIterator
+    (
+        const data_iterator_t&      data_iterator,
+        const index_iterator_t&     index_iterator,
+        const index_iterator_t&     lookahead_iterator,
+        const index_iterator_t&     end_iterator
+    )
+        : m_data_iterator       { data_iterator }
+        , m_index_iterator      { index_iterator }
+        , m_lookahead_iterator  { lookahead_iterator }
+        , m_end_iterator        { end_iterator }
+    { }
+
+    const index_iterator_t& get_internal_iterator() const { return m_index_iterator; }
+
+    GatherIterator& operator++()
+    {
+        SHAKE_COUNT_OPERATION( GatherIterator, "GatherIterator", increments );
+        ++m_index_iterator;
+        if ( m_lookahead_iterator != m_end_iterator )
+        {
+            prefetch_detail::prefetch_for_read( std::addressof( element( *m_lookahead_iterator ) ) );
+            ++m_lookahead_iterator;
+        }
+        return *this;
+    }
+
+    GatherIterator operator++(int) { GatherIterator result = *this; ++(*this); return result; }
+
+    bool operator==(const GatherIterator& other) const { SHAKE_COUNT_OPERATION( GatherIterator, "GatherIterator", comparisons ); return get_internal_iterator() == other.get_internal_iterator(); }
+    bool operator!=(const GatherIterator& other) const { return !(*this == other); }
+
+    reference operator*() const
+    {
+        SHAKE_COUNT_OPERATION( GatherIterator, "GatherIterator", dereferences );
+        return element( *m_index_iterator );
+    }
+
+private:
+    template<typename index_t>
+    reference element( const index_t& index ) const
+    {
+        return m_data_iterator[ static_cast<difference_type>( index ) ];
+    }
+
+private:
+    data_iterator_t     m_data_iterator;
+    index_iterator_t    m_index_iterator;
+    index_iterator_t    m_lookahead_iterator;
+    index_iterator_t    m_end_iterator;
+    SHAKE_COUNT_COPIES( GatherIterator, "GatherIterator" );
+};
+
+//----------------------------------------------------------------
+template<typename data_iterator_t, typename index_iterator_t>
+using GatherRange = Range<GatherIterator<data_iterator_t, index_iterator_t>>;
+
+//----------------------------------------------------------------
+// Iterates over the elements of the data range at the positions in the index range, like data[ indices[ i ] ],
+// prefetching the elements up to distance positions ahead.
+// The data range should be random-access, and the indices should be within its bounds.
+template<typename data_range_t, typename index_range_t>
+GatherRange<typename data_range_t::iterator, typename index_range_t::iterator> gather
+(
+    data_range_t    data_range,
+    index_range_t   index_range,
+    std::size_t     distance = default_prefetch_distance
+)
+{
+    using data_iterator_t   = typename data_range_t::iterator;
+    using index_iterator_t  = typename index_range_t::iterator;
+    static_assert
+    (
+        std::is_base_of_v<std::random_access_iterator_tag, typename std::iterator_traits<data_iterator_t>::iterator_category>,
+        "only random-access ranges can be gathered from"
+    );
+
+    const auto data_iterator  = std::begin( data_range );
+    const auto begin_iterator = std::begin( index_range );
+    const auto end_iterator   = std::end( index_range );
+
+    auto lookahead_iterator = begin_iterator;
+    for ( std::size_t i = 0; i < distance && lookahead_iterator != end_iterator; ++i, ++lookahead_iterator )
+    {
+        prefetch_detail::prefetch_for_read( std::addressof( data_iterator[ static_cast<std::ptrdiff_t>( *lookahead_iterator ) ] ) );
+    }
+
+    return Range
+    {
+        GatherIterator<data_iterator_t, index_iterator_t> { data_iterator, begin_iterator, lookahead_iterator, end_iterator },
+        GatherIterator<data_iterator_t, index_iterator_t> { data_iterator, end_iterator,   end_iterator,       end_iterator }
+    };
+}
+
+} // namespace shake
+
+#endif // PREFETCH_AHEAD_RANGE_HPP
@@ -0,0 +1,253 @@
+#ifndef PREFETCH_RANGE_HPP
+#define PREFETCH_RANGE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "instrumentation.hpp"
+#include "range.hpp"
+#include "trace.hpp"
+
+namespace shake {
+
+//----------------------------------------------------------------
+// A lock-free single-producer/single-consumer ring of batches.
+// A background thread iterates over the source range and fills the batches,
+// while the consuming thread reads batches that have already been filled.
+// The producer and consumer only synchronize through the head and tail counters.
+template<typename value_t>
+class PrefetchRing
+{
+public:
+    using batch_t = std::vector<value_t>;
+
+public:
+    PrefetchRing
+    (
+        std::size_t depth,
+        std::size_t batch_size
+    )
+        : m_batches     ( depth > 0 ? depth : 1 )
+        , m_batch_size  { batch_size > 0 ? batch_size : 1 }
+    {
+        for ( auto& batch : m_batches )
+        {
+            batch.reserve( m_batch_size );
+        }
+    }
+
+    PrefetchRing( const PrefetchRing& ) = delete;
+    PrefetchRing& operator=( const PrefetchRing& ) = delete;
+
+    ~PrefetchRing()
+    {
+        m_is_stopped.store( true, std::memory_order_relaxed );
+        if ( m_thread.joinable() )
+        {
+            m_thread.join();
+        }
+    }
+
+    // The range is copied into the producer thread, so it is only ever iterated over by that thread.
+    template<typename range_t>
+    void start( range_t source_range )
+    {
+        m_thread = std::thread( [ this, source_range ]() { produce( source_range ); } );
+    }
+
+    // Waits until a filled batch is available, and returns it.
+    // Returns nullptr when the source range is exhausted.
+    const batch_t* front()
+    {
+        const auto head = m_head.load( std::memory_order_relaxed );
+        if ( head == m_tail.load( std::memory_order_acquire ) && !wait_for_filled_batch( head ) )
+        {
+            if ( m_exception != nullptr )
+            {
+                std::rethrow_exception( m_exception );
+            }
+            return nullptr;
+        }
+        return &m_batches[ head % m_batches.size() ];
+    }
+
+    // Hands the front batch back to the producer
+    void pop()
+    {
+        m_head.store( m_head.load( std::memory_order_relaxed ) + 1, std::memory_order_release );
+    }
+
+private:
+    // Returns false if the producer finished without filling another batch
+    bool wait_for_filled_batch( std::size_t head ) const
+    {
+        SHAKE_TRACE_SCOPE( "prefetch", "consumer waits for producer" );
+        while ( head == m_tail.load( std::memory_order_acquire ) )
+        {
+            if ( m_is_producer_done.load( std::memory_order_acquire ) )
+            {
+                // the producer might have published a last batch before it finished
+                return head != m_tail.load( std::memory_order_acquire );
+            }
+            std::this_thread::yield();
+        }
+        return true;
+    }
+
+    // Returns false if the ring was destroyed while waiting
+    bool wait_for_free_batch( std::size_t tail ) const
+    {
+        SHAKE_TRACE_SCOPE( "prefetch", "producer waits for consumer" );
+        while ( tail - m_head.load( std::memory_order_acquire ) == m_batches.size() )
+        {
+            if ( m_is_stopped.load( std::memory_order_relaxed ) )
+            {
+                return false;
+            }
+            std::this_thread::yield();
+        }
+        return true;
+    }
+
+    template<typename range_t>
+    void produce( range_t source_range )
+    {
+        SHAKE_TRACE_THREAD_NAME( "prefetch producer" );
+        try
+        {
+            auto it = std::begin( source_range );
+            const auto end = std::end( source_range );
+            while ( it != end )
+            {
+                const auto tail = m_tail.load( std::memory_order_relaxed );
+                if ( tail - m_head.load( std::memory_order_acquire ) == m_batches.size() && !wait_for_free_batch( tail ) )
+                {
+                    return;
+                }
+
+                SHAKE_TRACE_SCOPE( "prefetch", "producer fills batch" );
+                auto& batch = m_batches[ tail % m_batches.size() ];
+                batch.clear();
+                for ( ; it != end && batch.size() < m_batch_size; ++it )
+                {
+                    batch.emplace_back( *it );
+                }
+                m_tail.store( tail + 1, std::memory_order_release );
+            }
+        }
+        catch ( ... )
+        {
+            m_exception = std::current_exception();
+        }
+        m_is_producer_done.store( true, std::memory_order_release );
+    }
+
+private:
+    std::vector<batch_t>        m_batches;
+    std::size_t                 m_batch_size;
+    std::atomic<std::size_t>    m_head              { 0 };
+    std::atomic<std::size_t>    m_tail              { 0 };
+    std::atomic<bool>           m_is_producer_done  { false };
+    std::atomic<bool>           m_is_stopped        { false };
+    std::exception_ptr          m_exception;
+    std::thread                 m_thread;
+};
+
+//----------------------------------------------------------------
+// Iterates over the batches that a background thread has prefetched.
+// This is a single pass input iterator: all copies share the same ring.
+template<typename value_t>
+class PrefetchIterator
+{
+public:
+    using ring_t = PrefetchRing<value_t>;
+
+public:
+    // iterator traits
+    using iterator_category = std::input_iterator_tag;
+    using value_type        = value_t;
+    using difference_type   = std::ptrdiff_t;
+    using pointer           = const value_t*;
+    using reference         = const value_t&;
+
+public:
+    // A default constructed iterator is the end iterator
+    PrefetchIterator() = default;
+
+    explicit
+    PrefetchIterator( std::shared_ptr<ring_t> ring )
+        : m_ring    { std::move( ring ) }
+        , m_batch   { m_ring->front() }
+    { }
+
+    bool is_done() const { return m_batch == nullptr; }
+
+    PrefetchIterator& operator++()
+    {
+        SHAKE_COUNT_OPERATION( PrefetchIterator, "PrefetchIterator", increments );
+        if ( ++m_index == m_batch->size() )
+        {
+            m_ring->pop();
+            m_batch = m_ring->front();
+            m_index = 0;
+        }
+        return *this;
+    }
+
+    PrefetchIterator operator++(int) { PrefetchIterator result = *this; ++(*this); return result; }
+
+    bool operator==( const PrefetchIterator& other ) const { SHAKE_COUNT_OPERATION( PrefetchIterator, "PrefetchIterator", comparisons ); return is_done() == other.is_done(); }
+    bool operator!=( const PrefetchIterator& other ) const { return !( *this == other ); }
+
+    const value_t& operator*() const
+    {
+        SHAKE_COUNT_OPERATION( PrefetchIterator, "PrefetchIterator", dereferences );
+        return ( *m_batch )[ m_index ];
+    }
+
+private:
+    std::shared_ptr<ring_t>                 m_ring;
+    const typename ring_t::batch_t*         m_batch = nullptr;
+    std::size_t                             m_index = 0;
+    SHAKE_COUNT_COPIES( PrefetchIterator, "PrefetchIterator" );
+};
+
+//----------------------------------------------------------------
+template<typename value_t>
+using PrefetchRange = Range<PrefetchIterator<value_t>>;
+
+//----------------------------------------------------------------
+// Iterates over the input range on a background thread, up to depth batches ahead of the consumer,
+// so that slow reading or parsing overlaps with the work done on the elements.
+// The elements are copied into the batches, so a range that produces views into a buffer
+// it reuses (such as lines over a stream) should be transformed into owning values first.
+// The background thread stops when the last iterator over the range is destroyed.
+template<typename range_t>
+auto prefetched
+(
+    range_t         input_range,
+    std::size_t     depth       = 4,
+    std::size_t     batch_size  = 1024
+)
+{
+    using value_t = std::remove_cv_t<typename range_t::iterator::value_type>;
+
+    const auto ring = std::make_shared<PrefetchRing<value_t>>( depth, batch_size );
+    ring->start( input_range );
+
+    return Range
+    {
+        PrefetchIterator<value_t> { ring },
+        PrefetchIterator<value_t> { }
+    };
+}
+
+} // namespace shake
+
+#endif // PREFETCH_RANGE_HPP
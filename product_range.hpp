@@ -0,0 +1,222 @@
+#ifndef PRODUCT_RANGE_HPP
+#define PRODUCT_RANGE_HPP
+
+#include <array>
+#include <cstddef>
+#include <iterator>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "instrumentation.hpp"
+#include "range.hpp"
+
+namespace shake {
+
+//----------------------------------------------------------------
+// Iterates over the cartesian product of multiple ranges, like nested loops over them,
+// and exposes their elements by combining them in tuples, like the combine iterator.
+// The last range is the innermost loop, so it changes fastest.
+// Incrementing carries from the innermost dimension outwards, without any division.
+// When all ranges are random-access, so is the product, over the flattened index space of all dimensions,
+// so that it can be split into balanced parts across all dimensions together, instead of only over the outer loop.
+template<typename... IteratorArgs>
+class ProductIterator
+{
+    static_assert( sizeof...( IteratorArgs ) > 0, "a product needs at least one range" );
+
+public:
+    using tuple_t = std::tuple<IteratorArgs...>;
+
+private:
+    static constexpr std::size_t n_dimensions = sizeof...( IteratorArgs );
+
+    static constexpr bool is_random_access = ( std::is_base_of_v< std::random_access_iterator_tag, typename std::iterator_traits<IteratorArgs>::iterator_category > && ... );
+
+public:
+    // iterator traits
+    // only random-access if all iterators are
+    using iterator_category = std::conditional_t<is_random_access, std::random_access_iterator_tag, std::forward_iterator_tag>;
+    using value_type        = std::tuple<decltype( *std::declval<const IteratorArgs&>() ) ...>;
+    using difference_type   = std::ptrdiff_t;
+    using pointer           = value_type*;
+    using reference         = value_type&;
+
+    using sizes_t = std::array<difference_type, n_dimensions>;
+
+public:
+    // The iterators start at the begin iterators, and are moved to the flat index.
+    constexpr
+    ProductIterator
+    (
+        const tuple_t&      begin_iterators,
+        const sizes_t&      sizes,
+        difference_type     flat_index
+    )
+        : m_begin_iterators { begin_iterators }
+        , m_iterators       { begin_iterators }
+        , m_sizes           { sizes }
+        , m_positions       { }
+        , m_flat_index      { 0 }
+    {
+        move_to( flat_index );
+    }
+
+    constexpr const tuple_t&   get_internal_iterator() const { return m_iterators; }
+    constexpr const sizes_t&   get_sizes()             const { return m_sizes; }
+    constexpr difference_type  get_flat_index()        const { return m_flat_index; }
+
+    constexpr ProductIterator& operator++()
+    {
+        SHAKE_COUNT_OPERATION( ProductIterator, "ProductIterator", increments );
+        increment<n_dimensions - 1>();
+        ++m_flat_index;
+        return *this;
+    }
+
+    constexpr ProductIterator operator++(int) { ProductIterator result = *this; ++(*this); return result; }
+
+    // Only available when all iterators are random-access, like the iterator_category says.
+    // Jumping computes the position in each dimension from the flat index.
+    constexpr ProductIterator&  operator--()                        { move_to( m_flat_index - 1 ); return *this; }
+    constexpr ProductIterator&  operator+=(difference_type n)       { move_to( m_flat_index + n ); return *this; }
+    constexpr ProductIterator&  operator-=(difference_type n)       { return *this += -n; }
+    constexpr ProductIterator   operator+ (difference_type n) const { ProductIterator result = *this; return result += n; }
+    constexpr ProductIterator   operator- (difference_type n) const { ProductIterator result = *this; return result -= n; }
+    constexpr difference_type   operator- (const ProductIterator& other) const { return m_flat_index - other.m_flat_index; }
+
+    constexpr bool operator==(const ProductIterator& other) const { SHAKE_COUNT_OPERATION( ProductIterator, "ProductIterator", comparisons ); return m_flat_index == other.m_flat_index; }
+    constexpr bool operator!=(const ProductIterator& other) const { return !(*this == other); }
+    constexpr bool operator< (const ProductIterator& other) const { return m_flat_index < other.m_flat_index; }
+
+    constexpr auto operator*() const
+    {
+        SHAKE_COUNT_OPERATION( ProductIterator, "ProductIterator", dereferences );
+        return std::apply
+        (
+            // like the combine iterator, maintain references, but store values for iterators that dereference to temporaries
+            []( auto&&... args ) { return std::tuple<decltype( *args ) ...>( ( *args ) ... ); },
+            m_iterators
+        );
+    }
+
+private:
+    // Increments the iterator of the dimension, and when it wraps around, carries over to the next outer dimension.
+    // The outermost dimension never wraps around, so that it ends up at the end of its range.
+    template<std::size_t dimension>
+    constexpr void increment()
+    {
+        auto& it = std::get<dimension>( m_iterators );
+        ++it;
+        if constexpr ( dimension > 0 )
+        {
+            if ( ++m_positions[ dimension ] == m_sizes[ dimension ] )
+            {
+                m_positions[ dimension ] = 0;
+                rewind<dimension>();
+                increment<dimension - 1>();
+            }
+        }
+        else
+        {
+            ++m_positions[ dimension ];
+        }
+    }
+
+    template<std::size_t dimension>
+    constexpr void rewind()
+    {
+        auto& it = std::get<dimension>( m_iterators );
+        if constexpr ( is_random_access )
+        {
+            it -= m_sizes[ dimension ];
+        }
+        else
+        {
+            it = std::get<dimension>( m_begin_iterators );
+        }
+    }
+
+    // Moves the iterators to the positions of the flat index, computed from the innermost dimension outwards.
+    // The iterators are moved relative to their current positions, so that they do not need to be assignable.
+    constexpr void move_to( difference_type flat_index )
+    {
+        m_flat_index = flat_index;
+        auto positions = sizes_t { };
+        if ( !is_empty() )
+        {
+            auto remaining = flat_index;
+            for ( std::size_t dimension = n_dimensions - 1; dimension > 0; --dimension )
+            {
+                positions[ dimension ] = remaining % m_sizes[ dimension ];
+                remaining /= m_sizes[ dimension ];
+            }
+            // the outermost position is allowed to reach the size, for the end iterator
+            positions[ 0 ] = remaining;
+        }
+        advance_all( positions, std::make_index_sequence<n_dimensions> { } );
+        m_positions = positions;
+    }
+
+    template<std::size_t... dimensions>
+    constexpr void advance_all( const sizes_t& positions, std::index_sequence<dimensions...> )
+    {
+        ( std::advance( std::get<dimensions>( m_iterators ), positions[ dimensions ] - m_positions[ dimensions ] ), ... );
+    }
+
+    constexpr bool is_empty() const
+    {
+        for ( const auto size : m_sizes )
+        {
+            if ( size == 0 )
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    tuple_t             m_begin_iterators;
+    tuple_t             m_iterators;
+    sizes_t             m_sizes;
+    sizes_t             m_positions;
+    difference_type     m_flat_index;
+    SHAKE_COUNT_COPIES( ProductIterator, "ProductIterator" );
+};
+
+//----------------------------------------------------------------
+template<typename... IteratorArgs>
+using ProductRange = Range<ProductIterator<IteratorArgs...>>;
+
+//----------------------------------------------------------------
+// The cartesian product of the ranges, which replaces nested loops over them:
+//      for ( const auto& [ i, j, k ] : product( range( n ), range( m ), range( l ) ) )
+// The number of elements is the product of the sizes of the ranges.
+template<typename... RangeArgs>
+constexpr ProductRange<typename RangeArgs::iterator...> product
+(
+    RangeArgs... range_args
+)
+{
+    using iterator_t = ProductIterator<typename RangeArgs::iterator...>;
+
+    const auto begin_iterators  = std::make_tuple( std::begin( range_args ) ... );
+    const auto sizes            = typename iterator_t::sizes_t { std::distance( std::begin( range_args ), std::end( range_args ) ) ... };
+
+    auto n_elements = typename iterator_t::difference_type { 1 };
+    for ( const auto size : sizes )
+    {
+        n_elements *= size;
+    }
+
+    return Range
+    {
+        iterator_t { begin_iterators, sizes, 0          },
+        iterator_t { begin_iterators, sizes, n_elements }
+    };
+}
+
+} // namespace shake
+
+#endif // PRODUCT_RANGE_HPP
@@ -1,7 +1,9 @@
 #ifndef RANGE_HPP
 #define RANGE_HPP
 
+#include <cstddef>
 #include <iterator>
+#include <type_traits>
 
 namespace shake {
 
@@ -24,6 +26,7 @@ public:
     // could be a const_iterator, dependent on how the range is constructed
     using iterator = iterator_t;
 
+    constexpr
     Range
     (
         iterator_t begin,
@@ -33,18 +36,30 @@ public:
         , m_end     { end }
     { }
 
-    iterator    begin() const  { return m_begin;  }
-    iterator    end()   const  { return m_end;    }
+    constexpr iterator  begin() const  { return m_begin;  }
+    constexpr iterator  end()   const  { return m_end;    }
 
 private:
     iterator    m_begin;
     iterator    m_end;
 };
 
+//----------------------------------------------------------------
+// Ranges are views that do not own the elements they iterate over, unlike containers.
+// This trait tells them apart, e.g. to know whether elements can be moved out of an rvalue.
+template<typename T>
+struct is_range : std::false_type { };
+
+template<typename iterator_t>
+struct is_range<Range<iterator_t>> : std::true_type { };
+
+template<typename T>
+inline constexpr bool is_range_v = is_range<T>::value;
+
 //----------------------------------------------------------------
 // Constructs a non-const range which means the elements that are iterated over can be changed.
 template<typename container_t>
-Range<typename container_t::iterator> range
+constexpr Range<typename container_t::iterator> range
 (
     container_t& v
 )
@@ -59,7 +74,7 @@ Range<typename container_t::iterator> range
 //----------------------------------------------------------------
 // Constructs a const range, which means the elements that are iterated over can not be changed.
 template<typename container_t>
-Range<typename container_t::const_iterator> const_range
+constexpr Range<typename container_t::const_iterator> const_range
 (
     container_t& v
 )
@@ -71,6 +86,44 @@ Range<typename container_t::const_iterator> const_range
     };
 }
 
+//----------------------------------------------------------------
+// Returns the iterator at the position of a random-access range,
+// which unranks the element in constant time for index ranges, and directly for the combinatorial ranges.
+template<typename range_t>
+constexpr typename range_t::iterator nth
+(
+    const range_t&  input_range,
+    std::size_t     position
+)
+{
+    return std::begin( input_range ) + static_cast<std::ptrdiff_t>( position );
+}
+
+//----------------------------------------------------------------
+// Returns one of n_parts consecutive parts of a random-access range, e.g. to divide the work over threads.
+// The sizes of the parts differ by at most one element, and together they cover the whole range.
+template<typename range_t>
+constexpr Range<typename range_t::iterator> split
+(
+    const range_t&  input_range,
+    std::size_t     n_parts,
+    std::size_t     part
+)
+{
+    const auto begin_iterator   = std::begin( input_range );
+    const auto size             = static_cast<std::size_t>( std::end( input_range ) - begin_iterator );
+    // the first size % n_parts parts get one extra element
+    const auto part_begin = [ & ]( std::size_t p )
+    {
+        return static_cast<std::ptrdiff_t>( p * ( size / n_parts ) + ( p < size % n_parts ? p : size % n_parts ) );
+    };
+    return Range<typename range_t::iterator>
+    {
+        begin_iterator + part_begin( part ),
+        begin_iterator + part_begin( part + 1 )
+    };
+}
+
 } // namespace shake
 
 #endif // RANGE_HPP
\ No newline at end of file
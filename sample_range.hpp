@@ -0,0 +1,226 @@
+#ifndef SAMPLE_RANGE_HPP
+#define SAMPLE_RANGE_HPP
+
+#include <cmath>
+#include <cstddef>
+#include <iterator>
+#include <limits>
+#include <random>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "collect.hpp"
+#include "instrumentation.hpp"
+#include "range.hpp"
+
+namespace shake {
+
+namespace sample_detail {
+
+//----------------------------------------------------------------
+// Advances the iterator by n elements, or to the end if there are fewer,
+// in constant time for random-access iterators, and without dereferencing any element otherwise.
+// Returns whether the end was reached before advancing n elements.
+template<typename iterator_t>
+bool skip( iterator_t& it, const iterator_t& end, std::size_t n )
+{
+    if constexpr ( std::is_base_of_v<std::random_access_iterator_tag, typename std::iterator_traits<iterator_t>::iterator_category> )
+    {
+        if ( static_cast<std::size_t>( end - it ) <= n )
+        {
+            it = end;
+            return true;
+        }
+        it += static_cast<std::ptrdiff_t>( n );
+        return false;
+    }
+    else
+    {
+        for ( ; n > 0 && it != end; --n, ++it ) { }
+        return it == end;
+    }
+}
+
+// A uniformly distributed number in ( 0, 1 ], so that its logarithm is finite
+template<typename random_engine_t>
+double random_open_unit( random_engine_t& engine )
+{
+    return 1.0 - std::uniform_real_distribution<double> { 0.0, 1.0 }( engine );
+}
+
+// Converts a number of elements to skip to a count, where counts beyond the size of any range mean skipping to the end
+inline std::size_t to_skip_count( double n_skipped )
+{
+    constexpr auto max_count = static_cast<double>( std::numeric_limits<std::size_t>::max() / 2 );
+    return n_skipped < max_count ? static_cast<std::size_t>( n_skipped ) : static_cast<std::size_t>( max_count );
+}
+
+} // namespace sample_detail
+
+//----------------------------------------------------------------
+// Selects k elements of a range uniformly at random in a single pass, like reservoir sampling, with O( k ) memory,
+// and returns them in a vector, in no particular order. A range with at most k elements is returned as a whole.
+// It uses Algorithm L (Li, 1994), which computes how many elements to skip before the next one that enters the reservoir,
+// so the random engine is only called about 3 k log( n / k ) times for n elements, instead of once per element,
+// and the skipped elements are not even dereferenced.
+template<typename range_t, typename random_engine_t>
+std::vector<collect_detail::value_t<range_t>> sample
+(
+    range_t             input_range,
+    std::size_t         k,
+    random_engine_t&&   engine
+)
+{
+    auto reservoir = std::vector<collect_detail::value_t<range_t>> { };
+    if ( k == 0 )
+    {
+        return reservoir;
+    }
+    reservoir.reserve( k );
+
+    auto it = std::begin( input_range );
+    const auto end = std::end( input_range );
+    for ( ; it != end && reservoir.size() < k; ++it )
+    {
+        reservoir.emplace_back( *it );
+    }
+
+    auto pick_slot = std::uniform_int_distribution<std::size_t> { 0, k - 1 };
+    // w is distributed like the largest of k uniform numbers, which is the threshold an element has to beat to be selected
+    auto w = std::exp( std::log( sample_detail::random_open_unit( engine ) ) / static_cast<double>( k ) );
+    while ( it != end )
+    {
+        const auto n_skipped = std::floor( std::log( sample_detail::random_open_unit( engine ) ) / std::log1p( -w ) );
+        if ( sample_detail::skip( it, end, sample_detail::to_skip_count( n_skipped ) ) )
+        {
+            break;
+        }
+        reservoir[ pick_slot( engine ) ] = *it;
+        ++it;
+        w *= std::exp( std::log( sample_detail::random_open_unit( engine ) ) / static_cast<double>( k ) );
+    }
+    return reservoir;
+}
+
+// Samples with a default seeded std::mt19937_64, so that every run selects the same elements
+template<typename range_t>
+std::vector<collect_detail::value_t<range_t>> sample
+(
+    range_t         input_range,
+    std::size_t     k
+)
+{
+    return sample( input_range, k, std::mt19937_64 { } );
+}
+
+//----------------------------------------------------------------
+// Iterates over the elements of a range that are each selected independently with the same probability.
+// Instead of drawing a random number per element, it draws the number of elements to skip before the next selected one
+// from a geometric distribution, so the random engine is only called about once per selected element,
+// and the skipped elements are not even dereferenced.
+// The iterator holds its own random engine, so copies of an iterator select the same elements.
+template<typename iterator_t, typename random_engine_t>
+class BernoulliIterator
+{
+public:
+    // iterator traits
+    using iterator_category = std::forward_iterator_tag;
+    using value_type        = typename std::iterator_traits<iterator_t>::value_type;
+    using difference_type   = std::ptrdiff_t;
+    using pointer           = typename std::iterator_traits<iterator_t>::pointer;
+    using reference         = decltype( *std::declval<const iterator_t&>() );
+
+public:
+    // Starts at the first selected element from the iterator on.
+    // The probability should be in [ 0, 1 ].
+    BernoulliIterator
+    (
+        const iterator_t&       iterator,
+        const iterator_t&       end_iterator,
+        double                  probability,
+        const random_engine_t&  engine
+    )
+        : m_iterator        { iterator }
+        , m_end_iterator    { end_iterator }
+        , m_probability     { probability }
+        , m_engine          { engine }
+    {
+        if ( m_probability <= 0.0 )
+        {
+            m_iterator = m_end_iterator;
+        }
+        skip_unselected();
+    }
+
+    const iterator_t& get_internal_iterator() const { return m_iterator; }
+
+    BernoulliIterator& operator++()
+    {
+        SHAKE_COUNT_OPERATION( BernoulliIterator, "BernoulliIterator", increments );
+        ++m_iterator;
+        skip_unselected();
+        return *this;
+    }
+
+    BernoulliIterator operator++(int) { BernoulliIterator result = *this; ++(*this); return result; }
+
+    bool operator==(const BernoulliIterator& other) const { SHAKE_COUNT_OPERATION( BernoulliIterator, "BernoulliIterator", comparisons ); return m_iterator == other.m_iterator; }
+    bool operator!=(const BernoulliIterator& other) const { return !(*this == other); }
+
+    reference operator*() const
+    {
+        SHAKE_COUNT_OPERATION( BernoulliIterator, "BernoulliIterator", dereferences );
+        return *m_iterator;
+    }
+
+private:
+    void skip_unselected()
+    {
+        if ( m_probability < 1.0 && m_iterator != m_end_iterator )
+        {
+            // the number of failures before the next success, drawn from a geometric distribution by inverting its distribution function
+            const auto n_skipped = std::floor( std::log( sample_detail::random_open_unit( m_engine ) ) / std::log1p( -m_probability ) );
+            sample_detail::skip( m_iterator, m_end_iterator, sample_detail::to_skip_count( n_skipped ) );
+        }
+    }
+
+private:
+    iterator_t          m_iterator;
+    iterator_t          m_end_iterator;
+    double              m_probability;
+    random_engine_t     m_engine;
+    SHAKE_COUNT_COPIES( BernoulliIterator, "BernoulliIterator" );
+};
+
+//----------------------------------------------------------------
+template<typename iterator_t, typename random_engine_t>
+using BernoulliRange = Range<BernoulliIterator<iterator_t, random_engine_t>>;
+
+//----------------------------------------------------------------
+// Selects each element of the range independently with the probability, like filtering with random.random() < p.
+// The random engine is copied into the range, so a range selects the same elements every time it is iterated over,
+// and a seeded engine selects the same elements in every run.
+template<typename range_t, typename random_engine_t = std::mt19937_64>
+BernoulliRange<typename range_t::iterator, random_engine_t> bernoulli
+(
+    range_t             input_range,
+    double              probability,
+    random_engine_t     engine = { }
+)
+{
+    using iterator_t = BernoulliIterator<typename range_t::iterator, random_engine_t>;
+
+    const auto begin_iterator   = std::begin( input_range );
+    const auto end_iterator     = std::end( input_range );
+
+    return Range
+    {
+        iterator_t { begin_iterator, end_iterator, probability, engine },
+        iterator_t { end_iterator,   end_iterator, probability, engine }
+    };
+}
+
+} // namespace shake
+
+#endif // SAMPLE_RANGE_HPP
@@ -0,0 +1,324 @@
+#ifndef SET_RANGE_HPP
+#define SET_RANGE_HPP
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <type_traits>
+
+#ifdef __SSE2__
+    #include <emmintrin.h>
+#endif
+
+#include "instrumentation.hpp"
+#include "range.hpp"
+
+namespace shake {
+
+namespace set_detail {
+
+//----------------------------------------------------------------
+// Whether the sorted elements can be searched with SSE2 for a value: 32-bit integers in contiguous memory, compared with <
+template<typename iterator_t, typename value_t, typename compare_t>
+inline constexpr bool is_simd_searchable_v =
+    std::contiguous_iterator<iterator_t>
+    && std::is_same_v<std::iter_value_t<iterator_t>, std::remove_cvref_t<value_t>>
+    && ( std::is_same_v<std::iter_value_t<iterator_t>, std::int32_t> || std::is_same_v<std::iter_value_t<iterator_t>, std::uint32_t> )
+    && ( std::is_same_v<compare_t, std::less<>> || std::is_same_v<compare_t, std::less<std::iter_value_t<iterator_t>>> );
+
+// The number of elements that are checked one block at a time, before galloping
+inline constexpr std::ptrdiff_t n_simd_elements = 16;
+
+//----------------------------------------------------------------
+// Returns the first element from it on that is not before the value, like std::lower_bound.
+// Elements that are close by are found with a few comparisons, and elements that are far away with galloping:
+// the step size doubles until an element is not before the value, and a binary search finishes the last step.
+// This way, skipping n elements takes about 2 log2( n ) comparisons, however long the range is.
+// Contiguous 32-bit integers are first checked 4 at a time with SSE2, and forward iterators are advanced one at a time.
+template<typename iterator_t, typename value_t, typename compare_t>
+iterator_t skip_to( iterator_t it, const iterator_t& end, const value_t& value, const compare_t& compare )
+{
+    using category_t = typename std::iterator_traits<iterator_t>::iterator_category;
+
+    if constexpr ( !std::is_base_of_v<std::random_access_iterator_tag, category_t> )
+    {
+        for ( ; it != end && std::invoke( compare, *it, value ); ++it ) { }
+        return it;
+    }
+    else
+    {
+#ifdef __SSE2__
+        if constexpr ( is_simd_searchable_v<iterator_t, value_t, compare_t> )
+        {
+            // unsigned integers are compared as signed ones, after flipping their highest bit
+            constexpr auto bias = std::is_signed_v<std::iter_value_t<iterator_t>> ? 0 : std::numeric_limits<std::int32_t>::min();
+            const auto needle = _mm_set1_epi32( static_cast<std::int32_t>( value ) ^ bias );
+            for ( std::ptrdiff_t n_checked = 0; n_checked < n_simd_elements && end - it >= 4; n_checked += 4, it += 4 )
+            {
+                const auto block = _mm_xor_si128( _mm_loadu_si128( reinterpret_cast<const __m128i*>( std::to_address( it ) ) ), _mm_set1_epi32( bias ) );
+                // a bit per element, set when the element is before the value, which are the first elements since they are sorted
+                const auto is_before = static_cast<unsigned int>( _mm_movemask_ps( _mm_castsi128_ps( _mm_cmplt_epi32( block, needle ) ) ) );
+                if ( is_before != 0xF )
+                {
+                    return it + std::countr_one( is_before );
+                }
+            }
+        }
+#endif
+        auto step = std::ptrdiff_t { 1 };
+        while ( end - it > step && std::invoke( compare, it[ step ], value ) )
+        {
+            it += step;
+            step *= 2;
+        }
+        return std::lower_bound( it, it + std::min( step + 1, end - it ), value, compare );
+    }
+}
+
+} // namespace set_detail
+
+//----------------------------------------------------------------
+enum class SetOperation
+{
+    intersection,
+    union_,
+    difference
+};
+
+//----------------------------------------------------------------
+// Iterates over the result of a set operation on two sorted ranges, without computing it up front,
+// with the same results as the std::set_intersection, std::set_union and std::set_difference algorithms,
+// which also means that duplicates are matched one to one.
+// Intersections and differences skip over elements that can not be part of the result by galloping,
+// so that small ranges are intersected with large ones in a time that is about logarithmic in the size of the large one.
+template<SetOperation operation, typename first_iterator_t, typename second_iterator_t, typename compare_t>
+class SetOperationIterator
+{
+public:
+    // iterator traits
+    using iterator_category = std::forward_iterator_tag;
+    using reference         = std::common_reference_t
+    <
+        decltype( *std::declval<const first_iterator_t&>() ),
+        decltype( *std::declval<const second_iterator_t&>() )
+    >;
+    using value_type        = std::remove_cvref_t<reference>;
+    using difference_type   = std::ptrdiff_t;
+    using pointer           = std::add_pointer_t<reference>;
+
+public:
+    // Starts at the first element of the result from the iterators on
+    SetOperationIterator
+    (
+        const first_iterator_t&     first_iterator,
+        const first_iterator_t&     first_end_iterator,
+        const second_iterator_t&    second_iterator,
+        const second_iterator_t&    second_end_iterator,
+        const compare_t&            compare
+    )
+        : m_first_iterator      { first_iterator }
+        , m_first_end_iterator  { first_end_iterator }
+        , m_second_iterator     { second_iterator }
+        , m_second_end_iterator { second_end_iterator }
+        , m_compare             { compare }
+    {
+        settle();
+    }
+
+    const first_iterator_t&     get_internal_iterator()     const { return m_first_iterator; }
+    const second_iterator_t&    get_second_iterator()       const { return m_second_iterator; }
+
+    SetOperationIterator& operator++()
+    {
+        SHAKE_COUNT_OPERATION( SetOperationIterator, "SetOperationIterator", increments );
+        if constexpr ( operation == SetOperation::union_ )
+        {
+            // the element came from the range that is not exhausted and not after the other, or from both when they are equal
+            if ( m_second_iterator == m_second_end_iterator )
+            {
+                ++m_first_iterator;
+            }
+            else if ( m_first_iterator == m_first_end_iterator || is_second_before_first() )
+            {
+                ++m_second_iterator;
+            }
+            else
+            {
+                if ( !is_first_before_second() )
+                {
+                    ++m_second_iterator;
+                }
+                ++m_first_iterator;
+            }
+        }
+        else if constexpr ( operation == SetOperation::intersection )
+        {
+            ++m_first_iterator;
+            ++m_second_iterator;
+        }
+        else
+        {
+            ++m_first_iterator;
+        }
+        settle();
+        return *this;
+    }
+
+    SetOperationIterator operator++(int) { SetOperationIterator result = *this; ++(*this); return result; }
+
+    bool operator==(const SetOperationIterator& other) const
+    {
+        SHAKE_COUNT_OPERATION( SetOperationIterator, "SetOperationIterator", comparisons );
+        return m_first_iterator == other.m_first_iterator && m_second_iterator == other.m_second_iterator;
+    }
+
+    bool operator!=(const SetOperationIterator& other) const { return !(*this == other); }
+
+    reference operator*() const
+    {
+        SHAKE_COUNT_OPERATION( SetOperationIterator, "SetOperationIterator", dereferences );
+        if constexpr ( operation == SetOperation::union_ )
+        {
+            if ( m_first_iterator == m_first_end_iterator || ( m_second_iterator != m_second_end_iterator && is_second_before_first() ) )
+            {
+                return *m_second_iterator;
+            }
+        }
+        return *m_first_iterator;
+    }
+
+private:
+    bool is_first_before_second() const { return std::invoke( m_compare, *m_first_iterator, *m_second_iterator ); }
+    bool is_second_before_first() const { return std::invoke( m_compare, *m_second_iterator, *m_first_iterator ); }
+
+    // Moves on to the next element of the result, or to the end, where both iterators are at their ends,
+    // so that all iterators at the end are equal
+    void settle()
+    {
+        if constexpr ( operation == SetOperation::intersection )
+        {
+            while ( m_first_iterator != m_first_end_iterator && m_second_iterator != m_second_end_iterator )
+            {
+                if ( is_first_before_second() )
+                {
+                    m_first_iterator = set_detail::skip_to( m_first_iterator, m_first_end_iterator, *m_second_iterator, m_compare );
+                }
+                else if ( is_second_before_first() )
+                {
+                    m_second_iterator = set_detail::skip_to( m_second_iterator, m_second_end_iterator, *m_first_iterator, m_compare );
+                }
+                else
+                {
+                    return;
+                }
+            }
+            m_first_iterator    = m_first_end_iterator;
+            m_second_iterator   = m_second_end_iterator;
+        }
+        else if constexpr ( operation == SetOperation::difference )
+        {
+            while ( m_first_iterator != m_first_end_iterator && m_second_iterator != m_second_end_iterator )
+            {
+                if ( is_first_before_second() )
+                {
+                    return;
+                }
+                if ( is_second_before_first() )
+                {
+                    m_second_iterator = set_detail::skip_to( m_second_iterator, m_second_end_iterator, *m_first_iterator, m_compare );
+                }
+                else
+                {
+                    ++m_first_iterator;
+                    ++m_second_iterator;
+                }
+            }
+            if ( m_first_iterator == m_first_end_iterator )
+            {
+                m_second_iterator = m_second_end_iterator;
+            }
+        }
+    }
+
+private:
+    first_iterator_t    m_first_iterator;
+    first_iterator_t    m_first_end_iterator;
+    second_iterator_t   m_second_iterator;
+    second_iterator_t   m_second_end_iterator;
+    compare_t           m_compare;
+    SHAKE_COUNT_COPIES( SetOperationIterator, "SetOperationIterator" );
+};
+
+//----------------------------------------------------------------
+template<SetOperation operation, typename first_iterator_t, typename second_iterator_t, typename compare_t>
+using SetOperationRange = Range<SetOperationIterator<operation, first_iterator_t, second_iterator_t, compare_t>>;
+
+namespace set_detail {
+
+template<SetOperation operation, typename first_range_t, typename second_range_t, typename compare_t>
+SetOperationRange<operation, typename first_range_t::iterator, typename second_range_t::iterator, compare_t> set_operation
+(
+    const first_range_t&    first_range,
+    const second_range_t&   second_range,
+    const compare_t&        compare
+)
+{
+    using iterator_t = SetOperationIterator<operation, typename first_range_t::iterator, typename second_range_t::iterator, compare_t>;
+
+    const auto first_end_iterator   = std::end( first_range );
+    const auto second_end_iterator  = std::end( second_range );
+
+    return Range
+    {
+        iterator_t { std::begin( first_range ), first_end_iterator, std::begin( second_range ), second_end_iterator, compare },
+        iterator_t { first_end_iterator,        first_end_iterator, second_end_iterator,        second_end_iterator, compare }
+    };
+}
+
+} // namespace set_detail
+
+//----------------------------------------------------------------
+// The elements of two ranges that are sorted by the comparison, that are in both, like std::set_intersection.
+template<typename first_range_t, typename second_range_t, typename compare_t = std::less<>>
+auto set_intersection
+(
+    first_range_t       first_range,
+    second_range_t      second_range,
+    const compare_t&    compare = { }
+)
+{
+    return set_detail::set_operation<SetOperation::intersection>( first_range, second_range, compare );
+}
+
+// The elements of two ranges that are sorted by the comparison, that are in either, like std::set_union.
+template<typename first_range_t, typename second_range_t, typename compare_t = std::less<>>
+auto set_union
+(
+    first_range_t       first_range,
+    second_range_t      second_range,
+    const compare_t&    compare = { }
+)
+{
+    return set_detail::set_operation<SetOperation::union_>( first_range, second_range, compare );
+}
+
+// The elements of the first of two ranges that are sorted by the comparison, that are not in the second, like std::set_difference.
+template<typename first_range_t, typename second_range_t, typename compare_t = std::less<>>
+auto set_difference
+(
+    first_range_t       first_range,
+    second_range_t      second_range,
+    const compare_t&    compare = { }
+)
+{
+    return set_detail::set_operation<SetOperation::difference>( first_range, second_range, compare );
+}
+
+} // namespace shake
+
+#endif // SET_RANGE_HPP
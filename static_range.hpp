@@ -0,0 +1,84 @@
+#ifndef STATIC_RANGE_HPP
+#define STATIC_RANGE_HPP
+
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "index_range.hpp"
+
+namespace shake {
+
+//----------------------------------------------------------------
+// An index known at compile time, so that it can index tuples and be used as a template argument.
+template<std::size_t index>
+using static_index_t = std::integral_constant<std::size_t, index>;
+
+//----------------------------------------------------------------
+// The indices from 0 to n_indices, for tiny fixed trip counts like the dimensions of a vector.
+// Its elements are compile-time constants, which can be unpacked with structured bindings:
+//      const auto [ x, y, z ] = static_range<3>();
+// It can also be iterated over like an index range, also during constant evaluation.
+template<std::size_t n_indices>
+class StaticRange
+{
+public:
+    using iterator = IndexIterator;
+
+    static constexpr std::size_t size() { return n_indices; }
+
+    constexpr iterator  begin() const { return iterator { 0 };          }
+    constexpr iterator  end()   const { return iterator { n_indices };  }
+
+    template<std::size_t index>
+    constexpr static_index_t<index> get() const
+    {
+        static_assert( index < n_indices, "index out of range" );
+        return { };
+    }
+};
+
+//----------------------------------------------------------------
+template<std::size_t n_indices>
+constexpr StaticRange<n_indices> static_range()
+{
+    return { };
+}
+
+//----------------------------------------------------------------
+namespace static_detail {
+
+template<typename function_t, std::size_t... indices>
+constexpr void call_for_each_index( function_t& function, std::index_sequence<indices...> )
+{
+    // the cast to void avoids calling an overloaded comma operator on the results
+    ( static_cast<void>( function( static_index_t<indices> { } ) ), ... );
+}
+
+} // namespace static_detail
+
+//----------------------------------------------------------------
+// Calls the function for each index from 0 to n_indices, in order, without a runtime loop.
+// Each index is passed as a static_index_t, so the body can use it in std::get or as a template argument:
+//      static_for<3>( [ & ]( auto i ) { sum += std::get<i>( tuple ); } );
+template<std::size_t n_indices, typename function_t>
+constexpr void static_for( function_t&& function )
+{
+    static_detail::call_for_each_index( function, std::make_index_sequence<n_indices> { } );
+}
+
+} // namespace shake
+
+//----------------------------------------------------------------
+// The tuple protocol, which enables structured bindings for static ranges
+template<std::size_t n_indices>
+struct std::tuple_size<shake::StaticRange<n_indices>> : std::integral_constant<std::size_t, n_indices> { };
+
+template<std::size_t index, std::size_t n_indices>
+struct std::tuple_element<index, shake::StaticRange<n_indices>>
+{
+    using type = shake::static_index_t<index>;
+};
+
+#endif // STATIC_RANGE_HPP
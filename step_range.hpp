@@ -4,6 +4,7 @@
 #include <cstddef>
 #include <iterator>
 
+#include "instrumentation.hpp"
 #include "range.hpp"
 
 namespace shake {
@@ -13,39 +14,64 @@ class StepIterator
 {
 public:
     // iterator traits
-    using iterator_category = typename iterator_t::iterator_category;
-    using value_type        = typename iterator_t::value_type;
-    using difference_type   = typename iterator_t::difference_type;
-    using pointer           = typename iterator_t::pointer;
-    using reference         = typename iterator_t::reference;
+    using iterator_category = typename std::iterator_traits<iterator_t>::iterator_category;
+    using value_type        = typename std::iterator_traits<iterator_t>::value_type;
+    using difference_type   = typename std::iterator_traits<iterator_t>::difference_type;
+    using pointer           = typename std::iterator_traits<iterator_t>::pointer;
+    // whatever the internal iterator produces, so that elements are not copied
+    using reference         = decltype( *std::declval<const iterator_t&>() );
 
 public:
-    explicit
+    constexpr StepIterator() = default;
+
+    constexpr explicit
     StepIterator
-    ( 
-        iterator_t iterator, 
-        std::size_t step_size 
-    ) 
+    (
+        iterator_t iterator,
+        std::size_t step_size
+    )
         : m_iterator    { iterator  } 
         , m_step_size   { step_size }
     { }
 
-    const iterator_t& get_internal_iterator() const { return m_iterator; }
+    constexpr const iterator_t& get_internal_iterator() const { return m_iterator; }
+
+    constexpr StepIterator&  operator++()       { SHAKE_COUNT_OPERATION( StepIterator, "StepIterator", increments ); std::advance( m_iterator, m_step_size ); return *this; }
+    constexpr StepIterator   operator++(int)    { StepIterator result = *this; ++(*this); return result; }
 
-    StepIterator&  operator++()       { std::advance( m_iterator, m_step_size ); return *this; }
-    StepIterator   operator++(int)    { IndexIterator result = *this; ++(*this); return result; }
+    // Only available when the internal iterator supports them, like its iterator_category says
+    constexpr StepIterator&   operator--()                        { std::advance( m_iterator, -step_size() ); return *this; }
+    constexpr StepIterator    operator--(int)                     { StepIterator result = *this; --(*this); return result; }
+    constexpr StepIterator&   operator+=(difference_type n)       { std::advance( m_iterator, n * step_size() ); return *this; }
+    constexpr StepIterator&   operator-=(difference_type n)       { std::advance( m_iterator, -n * step_size() ); return *this; }
+    constexpr StepIterator    operator+ (difference_type n) const { StepIterator result = *this; return result += n; }
+    constexpr StepIterator    operator- (difference_type n) const { StepIterator result = *this; return result -= n; }
+    constexpr difference_type operator- (const StepIterator& other) const { return ( m_iterator - other.m_iterator ) / step_size(); }
 
-    bool operator==(StepIterator other) const { return get_internal_iterator() == other.get_internal_iterator(); }
-    bool operator!=(StepIterator other) const { return !(*this == other); }
+    constexpr bool operator==(StepIterator other) const { SHAKE_COUNT_OPERATION( StepIterator, "StepIterator", comparisons ); return get_internal_iterator() == other.get_internal_iterator(); }
+    constexpr bool operator!=(StepIterator other) const { return !(*this == other); }
+    constexpr bool operator< (const StepIterator& other) const { return get_internal_iterator() <  other.get_internal_iterator(); }
+    constexpr bool operator> (const StepIterator& other) const { return get_internal_iterator() >  other.get_internal_iterator(); }
+    constexpr bool operator<=(const StepIterator& other) const { return get_internal_iterator() <= other.get_internal_iterator(); }
+    constexpr bool operator>=(const StepIterator& other) const { return get_internal_iterator() >= other.get_internal_iterator(); }
 
-    value_type operator*() const
+    constexpr reference operator*() const
     {
+        SHAKE_COUNT_OPERATION( StepIterator, "StepIterator", dereferences );
         return *m_iterator;
     }
 
+    constexpr reference operator[](difference_type n) const { return *( *this + n ); }
+
+    friend constexpr StepIterator operator+( difference_type n, const StepIterator& it ) { return it + n; }
+
+private:
+    constexpr difference_type step_size() const { return static_cast<difference_type>( m_step_size ); }
+
 private:
-    iterator_t m_iterator;
-    std::size_t m_step_size;
+    iterator_t m_iterator {};
+    std::size_t m_step_size = 1;
+    SHAKE_COUNT_COPIES( StepIterator, "StepIterator" );
 };
 
 //----------------------------------------------------------------
@@ -54,7 +80,7 @@ using StepRange = Range<StepIterator<iterator_t>>;
 
 //----------------------------------------------------------------
 template<typename range_t>
-StepRange<typename range_t::iterator> step
+constexpr StepRange<typename range_t::iterator> step
 (
     range_t input_range,
     std::size_t step_size
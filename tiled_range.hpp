@@ -0,0 +1,387 @@
+#ifndef TILED_RANGE_HPP
+#define TILED_RANGE_HPP
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <iterator>
+#include <optional>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include <unistd.h>
+
+#include "index_range.hpp"
+#include "instrumentation.hpp"
+#include "product_range.hpp"
+#include "range.hpp"
+#include "transform_range.hpp"
+
+namespace shake {
+
+namespace tiled_detail {
+
+// an index iterator for each dimension
+template<std::size_t dimension>
+struct index_iterator_for
+{
+    using type = IndexIterator;
+};
+
+template<typename dimensions_t>
+struct index_nd_range;
+
+template<std::size_t... dimensions>
+struct index_nd_range<std::index_sequence<dimensions...>>
+{
+    using type = ProductRange<typename index_iterator_for<dimensions>::type ...>;
+};
+
+} // namespace tiled_detail
+
+//----------------------------------------------------------------
+// The product of index ranges over each dimension, which yields tuples of indices.
+template<std::size_t n_dimensions>
+using IndexNdRange = typename tiled_detail::index_nd_range<std::make_index_sequence<n_dimensions>>::type;
+
+//----------------------------------------------------------------
+// Iterates over all indices in a multi-dimensional space, with the last dimension as the innermost loop:
+//      for ( const auto& [ i, j, k ] : range_nd<3>( { n0, n1, n2 } ) )
+template<std::size_t n_dimensions>
+constexpr IndexNdRange<n_dimensions> range_nd
+(
+    const std::array<std::size_t, n_dimensions>& sizes
+)
+{
+    return [ & ]<std::size_t... dimensions>( std::index_sequence<dimensions...> )
+    {
+        return product( range( sizes[ dimensions ] ) ... );
+    }( std::make_index_sequence<n_dimensions> { } );
+}
+
+//----------------------------------------------------------------
+// The sizes of the data caches, as reported by the system, or typical sizes when it does not report them.
+struct CacheSizes
+{
+    std::size_t l1d;
+    std::size_t l2;
+};
+
+inline CacheSizes detect_cache_sizes()
+{
+    const auto detect = []( int name, std::size_t fallback )
+    {
+        const auto size = ::sysconf( name );
+        return size > 0 ? static_cast<std::size_t>( size ) : fallback;
+    };
+    static const auto sizes = CacheSizes
+    {
+        detect( _SC_LEVEL1_DCACHE_SIZE, std::size_t { 32 } << 10 ),
+        detect( _SC_LEVEL2_CACHE_SIZE,  std::size_t { 1 } << 20 )
+    };
+    return sizes;
+}
+
+//----------------------------------------------------------------
+// Chooses tile sizes of about equal length in each dimension, so that the elements of a tile take up half of the cache,
+// leaving room for the neighbouring elements that stencils read, and for other data.
+// The innermost tile size is a multiple of a cache line, so that tiles do not share cache lines.
+// Tiles are never larger than the space itself.
+template<std::size_t n_dimensions>
+std::array<std::size_t, n_dimensions> default_tile_sizes
+(
+    const std::array<std::size_t, n_dimensions>&    sizes,
+    std::size_t                                     bytes_per_element   = sizeof( double ),
+    std::size_t                                     cache_size          = detect_cache_sizes().l1d
+)
+{
+    constexpr std::size_t cache_line_size = 64;
+
+    const auto n_elements   = std::max<std::size_t>( cache_size / 2 / bytes_per_element, 1 );
+    const auto tile_size    = std::max<std::size_t>( static_cast<std::size_t>( std::pow( static_cast<double>( n_elements ), 1.0 / n_dimensions ) ), 1 );
+    const auto line_size    = std::max<std::size_t>( cache_line_size / bytes_per_element, 1 );
+
+    auto tile_sizes = std::array<std::size_t, n_dimensions> { };
+    tile_sizes.fill( tile_size );
+    tile_sizes.back() = ( tile_size + line_size - 1 ) / line_size * line_size;
+    for ( std::size_t dimension = 0; dimension < n_dimensions; ++dimension )
+    {
+        tile_sizes[ dimension ] = std::clamp<std::size_t>( tile_sizes[ dimension ], 1, std::max<std::size_t>( sizes[ dimension ], 1 ) );
+    }
+    return tile_sizes;
+}
+
+namespace tiled_detail {
+
+//----------------------------------------------------------------
+// The first index and the number of indices in each dimension of a multi-dimensional index range
+template<std::size_t n_dimensions>
+using bounds_t = std::array<std::size_t, n_dimensions>;
+
+template<typename... IteratorArgs>
+auto origin( const Range<ProductIterator<IteratorArgs...>>& nd_range )
+{
+    return std::apply
+    (
+        []( const auto&... iterators ) { return bounds_t<sizeof...( IteratorArgs )> { *iterators ... }; },
+        nd_range.begin().get_internal_iterator()
+    );
+}
+
+// The sizes come from both ends, since a part of a product, like one from split, covers only some of its indices.
+// Going outwards from the innermost dimension, the part either fits in the rest of the dimension,
+// or it has to span whole runs of it, so that its indices form a block as well.
+// Tiling any other part would visit wrong indices, so it is rejected with std::invalid_argument.
+template<typename... IteratorArgs>
+auto sizes( const Range<ProductIterator<IteratorArgs...>>& nd_range )
+{
+    constexpr auto n_dimensions = sizeof...( IteratorArgs );
+
+    const auto begin_iterator   = nd_range.begin();
+    const auto& full_sizes      = begin_iterator.get_sizes();
+
+    auto result     = bounds_t<n_dimensions> { };
+    result.fill( 1 );
+    auto n_indices  = nd_range.end() - begin_iterator;
+    auto remaining  = begin_iterator.get_flat_index();
+    for ( std::size_t dimension = n_dimensions; dimension-- > 0; )
+    {
+        const auto position = dimension > 0 && full_sizes[ dimension ] > 0 ? remaining % full_sizes[ dimension ] : remaining;
+        if ( dimension == 0 || n_indices <= full_sizes[ dimension ] - position )
+        {
+            result[ dimension ] = static_cast<std::size_t>( n_indices );
+            break;
+        }
+        if ( position != 0 || n_indices % full_sizes[ dimension ] != 0 )
+        {
+            throw std::invalid_argument( "shake: only parts of a product that form a block can be tiled" );
+        }
+        result[ dimension ] = static_cast<std::size_t>( full_sizes[ dimension ] );
+        n_indices /= full_sizes[ dimension ];
+        remaining /= full_sizes[ dimension ];
+    }
+    return result;
+}
+
+} // namespace tiled_detail
+
+//----------------------------------------------------------------
+// The tiles of a multi-dimensional index range, which are multi-dimensional index ranges themselves.
+// Tiles are visited in the same order as the indices, with the last dimension as the innermost loop,
+// and the tiles at the upper boundaries are smaller when the tile sizes do not divide the sizes.
+// The range of tiles is random-access, so it can be split into parts of whole tiles.
+// The index range can also be a part of a product, like one from split, as long as its indices form a block,
+// e.g. whole rows of the outermost dimension, otherwise std::invalid_argument is thrown.
+template<typename... IteratorArgs>
+auto tiles
+(
+    const Range<ProductIterator<IndexIterator, IteratorArgs...>>&   nd_range,
+    const std::array<std::size_t, 1 + sizeof...( IteratorArgs )>&   tile_sizes
+)
+{
+    constexpr auto n_dimensions = 1 + sizeof...( IteratorArgs );
+    using tile_t        = IndexNdRange<n_dimensions>;
+    using tile_index_t  = typename IndexNdRange<n_dimensions>::iterator::value_type;
+
+    const auto origin   = tiled_detail::origin( nd_range );
+    const auto sizes    = tiled_detail::sizes( nd_range );
+
+    auto n_tiles = std::array<std::size_t, n_dimensions> { };
+    for ( std::size_t dimension = 0; dimension < n_dimensions; ++dimension )
+    {
+        n_tiles[ dimension ] = ( sizes[ dimension ] + tile_sizes[ dimension ] - 1 ) / tile_sizes[ dimension ];
+    }
+
+    return transform<tile_index_t, tile_t>
+    (
+        range_nd( n_tiles ),
+        [ origin, sizes, tile_sizes ]( tile_index_t tile_index )
+        {
+            return [ & ]<std::size_t... dimensions>( std::index_sequence<dimensions...> )
+            {
+                const auto begin_index = [ & ]( std::size_t dimension, std::size_t tile )
+                {
+                    return origin[ dimension ] + std::min( tile * tile_sizes[ dimension ], sizes[ dimension ] );
+                };
+                return product
+                (
+                    range
+                    (
+                        begin_index( dimensions, std::get<dimensions>( tile_index ) ),
+                        begin_index( dimensions, std::get<dimensions>( tile_index ) + 1 )
+                    ) ...
+                );
+            }( std::make_index_sequence<n_dimensions> { } );
+        }
+    );
+}
+
+//----------------------------------------------------------------
+// The tiles of a multi-dimensional index range, with tile sizes that fit the L1 data cache
+template<typename... IteratorArgs>
+auto tiles
+(
+    const Range<ProductIterator<IndexIterator, IteratorArgs...>>& nd_range
+)
+{
+    return tiles( nd_range, default_tile_sizes( tiled_detail::sizes( nd_range ) ) );
+}
+
+//----------------------------------------------------------------
+// Iterates over all indices of a multi-dimensional index range, tile by tile.
+// Within a tile and between tiles, the last dimension is the innermost loop,
+// and incrementing carries outwards like the product iterator does, without any division.
+// Its state only consists of a few arrays of indices, so that compilers can keep it in registers.
+template<std::size_t n_dimensions>
+class TiledIndexIterator
+{
+public:
+    using indices_t = std::array<std::size_t, n_dimensions>;
+
+public:
+    // iterator traits
+    using iterator_category = std::forward_iterator_tag;
+    using value_type        = typename IndexNdRange<n_dimensions>::iterator::value_type;
+    using difference_type   = std::ptrdiff_t;
+    using pointer           = value_type*;
+    using reference         = value_type&;
+
+public:
+    // Starts at the first index of the first tile, and counts the number of indices visited so far,
+    // so that the end iterator only needs the total number of indices.
+    TiledIndexIterator
+    (
+        const indices_t&    origin,
+        const indices_t&    sizes,
+        const indices_t&    tile_sizes,
+        std::size_t         n_visited
+    )
+        : m_tile_sizes      { tile_sizes }
+        , m_n_visited       { n_visited }
+    {
+        for ( std::size_t dimension = 0; dimension < n_dimensions; ++dimension )
+        {
+            m_origin    [ dimension ] = origin[ dimension ];
+            m_end       [ dimension ] = origin[ dimension ] + sizes[ dimension ];
+            m_tile_begin[ dimension ] = origin[ dimension ];
+            m_tile_end  [ dimension ] = std::min( origin[ dimension ] + tile_sizes[ dimension ], m_end[ dimension ] );
+        }
+        m_indices = m_tile_begin;
+    }
+
+    const indices_t& get_internal_indices() const { return m_indices; }
+
+    TiledIndexIterator& operator++()
+    {
+        SHAKE_COUNT_OPERATION( TiledIndexIterator, "TiledIndexIterator", increments );
+        ++m_n_visited;
+        increment<n_dimensions - 1>();
+        return *this;
+    }
+
+    TiledIndexIterator operator++(int) { TiledIndexIterator result = *this; ++(*this); return result; }
+
+    bool operator==(const TiledIndexIterator& other) const { SHAKE_COUNT_OPERATION( TiledIndexIterator, "TiledIndexIterator", comparisons ); return m_n_visited == other.m_n_visited; }
+    bool operator!=(const TiledIndexIterator& other) const { return !(*this == other); }
+
+    // like the product of index ranges, the tuple holds copies of the indices
+    value_type operator*() const
+    {
+        SHAKE_COUNT_OPERATION( TiledIndexIterator, "TiledIndexIterator", dereferences );
+        return std::apply( []( const auto&... indices ) { return value_type { indices ... }; }, m_indices );
+    }
+
+private:
+    template<std::size_t dimension>
+    void increment()
+    {
+        if ( ++m_indices[ dimension ] == m_tile_end[ dimension ] )
+        {
+            m_indices[ dimension ] = m_tile_begin[ dimension ];
+            if constexpr ( dimension > 0 )
+            {
+                increment<dimension - 1>();
+            }
+            else
+            {
+                next_tile();
+            }
+        }
+    }
+
+    // Moves to the first index of the next tile, carrying outwards over the tiles
+    void next_tile()
+    {
+        for ( std::size_t dimension = n_dimensions; dimension-- > 0; )
+        {
+            m_tile_begin[ dimension ] = m_tile_end[ dimension ];
+            if ( m_tile_begin[ dimension ] < m_end[ dimension ] )
+            {
+                m_tile_end[ dimension ] = std::min( m_tile_begin[ dimension ] + m_tile_sizes[ dimension ], m_end[ dimension ] );
+                break;
+            }
+            m_tile_begin[ dimension ] = m_origin[ dimension ];
+            m_tile_end  [ dimension ] = std::min( m_origin[ dimension ] + m_tile_sizes[ dimension ], m_end[ dimension ] );
+        }
+        m_indices = m_tile_begin;
+    }
+
+private:
+    indices_t       m_origin;
+    indices_t       m_end;
+    indices_t       m_tile_sizes;
+    indices_t       m_tile_begin;
+    indices_t       m_tile_end;
+    indices_t       m_indices;
+    std::size_t     m_n_visited;
+    SHAKE_COUNT_COPIES( TiledIndexIterator, "TiledIndexIterator" );
+};
+
+//----------------------------------------------------------------
+template<std::size_t n_dimensions>
+using TiledIndexRange = Range<TiledIndexIterator<n_dimensions>>;
+
+//----------------------------------------------------------------
+// Iterates over all indices of a multi-dimensional index range, tile by tile,
+// so that loops over neighbouring elements, like stencils and matrix operations, keep reusing the same cache lines.
+// Like for tiles, a part of a product works as long as its indices form a block, otherwise std::invalid_argument is thrown.
+// To divide the work over threads by tile, split the range of tiles instead, and loop over each tile:
+//      for ( const auto& tile : split( tiles( nd_range ), n_threads, thread ) )
+//          for ( const auto& [ i, j ] : tile )
+template<typename... IteratorArgs>
+TiledIndexRange<1 + sizeof...( IteratorArgs )> tiled
+(
+    const Range<ProductIterator<IndexIterator, IteratorArgs...>>&   nd_range,
+    const std::array<std::size_t, 1 + sizeof...( IteratorArgs )>&   tile_sizes
+)
+{
+    constexpr auto n_dimensions = 1 + sizeof...( IteratorArgs );
+
+    const auto origin   = tiled_detail::origin( nd_range );
+    const auto sizes    = tiled_detail::sizes( nd_range );
+    const auto n_total  = static_cast<std::size_t>( std::distance( nd_range.begin(), nd_range.end() ) );
+
+    return Range
+    {
+        TiledIndexIterator<n_dimensions> { origin, sizes, tile_sizes, 0       },
+        TiledIndexIterator<n_dimensions> { origin, sizes, tile_sizes, n_total }
+    };
+}
+
+//----------------------------------------------------------------
+// Iterates over all indices tile by tile, with tile sizes that fit the L1 data cache
+template<typename... IteratorArgs>
+TiledIndexRange<1 + sizeof...( IteratorArgs )> tiled
+(
+    const Range<ProductIterator<IndexIterator, IteratorArgs...>>& nd_range
+)
+{
+    return tiled( nd_range, default_tile_sizes( tiled_detail::sizes( nd_range ) ) );
+}
+
+} // namespace shake
+
+#endif // TILED_RANGE_HPP
@@ -0,0 +1,257 @@
+#ifndef TRACE_HPP
+#define TRACE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace shake {
+
+//----------------------------------------------------------------
+// A single timed section of work on a single thread.
+// Names and categories are not copied, so they should be string literals.
+struct TraceEvent
+{
+    const char*     category;
+    const char*     name;
+    std::int64_t    begin_ns;
+    std::int64_t    duration_ns;
+};
+
+//----------------------------------------------------------------
+// The events recorded by a single thread.
+// Only the owning thread appends, and it publishes each event through an atomic count,
+// so that recording never takes a lock, and the events can be read from another thread at any time.
+// When the buffer is full, further events are dropped and counted instead.
+class TraceBuffer
+{
+public:
+    TraceBuffer
+    (
+        std::size_t     thread_index,
+        std::size_t     capacity
+    )
+        : m_thread_index    { thread_index }
+        , m_events          ( capacity )
+    { }
+
+    void record( const TraceEvent& event )
+    {
+        const auto size = m_size.load( std::memory_order_relaxed );
+        if ( size == m_events.size() )
+        {
+            m_n_dropped.fetch_add( 1, std::memory_order_relaxed );
+            return;
+        }
+        m_events[ size ] = event;
+        m_size.store( size + 1, std::memory_order_release );
+    }
+
+    void set_thread_name( std::string name )
+    {
+        const auto lock = std::lock_guard { m_name_mutex };
+        m_thread_name = std::move( name );
+    }
+
+    std::size_t         thread_index()  const { return m_thread_index; }
+    std::size_t         size()          const { return m_size.load( std::memory_order_acquire ); }
+    std::size_t         n_dropped()     const { return m_n_dropped.load( std::memory_order_relaxed ); }
+    const TraceEvent&   operator[]( std::size_t index ) const { return m_events[ index ]; }
+
+    std::string thread_name() const
+    {
+        const auto lock = std::lock_guard { m_name_mutex };
+        return m_thread_name;
+    }
+
+private:
+    std::size_t                 m_thread_index;
+    std::vector<TraceEvent>     m_events;
+    std::atomic<std::size_t>    m_size          { 0 };
+    std::atomic<std::size_t>    m_n_dropped     { 0 };
+    mutable std::mutex          m_name_mutex;
+    std::string                 m_thread_name;
+};
+
+//----------------------------------------------------------------
+// Collects the trace buffers of all threads, and writes them as a Chrome trace,
+// which can be opened in chrome://tracing or https://ui.perfetto.dev without any other tooling.
+// A thread only takes a lock the first time it records an event, to register its buffer.
+class Tracer
+{
+public:
+    using clock_t = std::chrono::steady_clock;
+
+    static constexpr std::size_t events_per_thread = std::size_t { 1 } << 16;
+
+public:
+    static Tracer& instance()
+    {
+        static auto tracer = Tracer { };
+        return tracer;
+    }
+
+    Tracer( const Tracer& ) = delete;
+    Tracer& operator=( const Tracer& ) = delete;
+
+    std::int64_t now_ns() const
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>( clock_t::now() - m_start ).count();
+    }
+
+    TraceBuffer& thread_buffer()
+    {
+        thread_local auto buffer = register_thread();
+        return *buffer;
+    }
+
+    void record( const TraceEvent& event )
+    {
+        thread_buffer().record( event );
+    }
+
+    // Events that are still being recorded while writing might be left out.
+    // The number of events that did not fit in the buffers is written as metadata, so that an incomplete trace can be recognized.
+    void write_chrome_trace( std::ostream& stream ) const
+    {
+        const auto lock = std::lock_guard { m_mutex };
+        stream << "{\"traceEvents\":[";
+        auto separator = "\n";
+        auto n_dropped = std::size_t { 0 };
+        for ( const auto& buffer : m_buffers )
+        {
+            n_dropped += buffer->n_dropped();
+            const auto thread_name = buffer->thread_name();
+            if ( !thread_name.empty() )
+            {
+                stream << separator << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->thread_index()
+                       << ",\"args\":{\"name\":\"" << escaped( thread_name ) << "\"}}";
+                separator = ",\n";
+            }
+            const auto size = buffer->size();
+            for ( std::size_t i = 0; i < size; ++i )
+            {
+                const auto& event = ( *buffer )[ i ];
+                // timestamps are in microseconds
+                stream << separator << "{\"name\":\"" << escaped( event.name ) << "\",\"cat\":\"" << escaped( event.category )
+                       << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->thread_index()
+                       << ",\"ts\":" << static_cast<double>( event.begin_ns ) / 1000.0
+                       << ",\"dur\":" << static_cast<double>( event.duration_ns ) / 1000.0 << "}";
+                separator = ",\n";
+            }
+        }
+        stream << "\n],\"displayTimeUnit\":\"ns\",\"otherData\":{\"dropped_events\":" << n_dropped << "}}\n";
+    }
+
+    void write_chrome_trace( const std::filesystem::path& path ) const
+    {
+        auto stream = std::ofstream { path, std::ios::trunc };
+        write_chrome_trace( stream );
+    }
+
+private:
+    Tracer() = default;
+
+    std::shared_ptr<TraceBuffer> register_thread()
+    {
+        const auto lock = std::lock_guard { m_mutex };
+        m_buffers.emplace_back( std::make_shared<TraceBuffer>( m_buffers.size(), events_per_thread ) );
+        return m_buffers.back();
+    }
+
+    // Escapes the text for a JSON string, in which control characters are not allowed as they are
+    static std::string escaped( const std::string& text )
+    {
+        constexpr char hex_digits[] = "0123456789abcdef";
+        auto result = std::string { };
+        for ( const auto c : text )
+        {
+            switch ( c )
+            {
+                case '"':   result += "\\\""; break;
+                case '\\':  result += "\\\\"; break;
+                case '\b':  result += "\\b"; break;
+                case '\f':  result += "\\f"; break;
+                case '\n':  result += "\\n"; break;
+                case '\r':  result += "\\r"; break;
+                case '\t':  result += "\\t"; break;
+                default:
+                    if ( static_cast<unsigned char>( c ) < 0x20 )
+                    {
+                        result += "\\u00";
+                        result += hex_digits[ static_cast<unsigned char>( c ) >> 4 ];
+                        result += hex_digits[ static_cast<unsigned char>( c ) & 0xF ];
+                    }
+                    else
+                    {
+                        result += c;
+                    }
+            }
+        }
+        return result;
+    }
+
+private:
+    const clock_t::time_point                   m_start = clock_t::now();
+    mutable std::mutex                          m_mutex;
+    std::vector<std::shared_ptr<TraceBuffer>>   m_buffers;
+};
+
+//----------------------------------------------------------------
+// Records the time between its construction and destruction as an event on the current thread.
+class TraceScope
+{
+public:
+    TraceScope
+    (
+        const char* category,
+        const char* name
+    )
+        : m_category    { category }
+        , m_name        { name }
+        , m_begin_ns    { Tracer::instance().now_ns() }
+    { }
+
+    TraceScope( const TraceScope& ) = delete;
+    TraceScope& operator=( const TraceScope& ) = delete;
+
+    ~TraceScope()
+    {
+        auto& tracer = Tracer::instance();
+        tracer.record( TraceEvent { m_category, m_name, m_begin_ns, tracer.now_ns() - m_begin_ns } );
+    }
+
+private:
+    const char*     m_category;
+    const char*     m_name;
+    std::int64_t    m_begin_ns;
+};
+
+} // namespace shake
+
+//----------------------------------------------------------------
+// Define SHAKE_TRACE to record when the parallel and pipelined ranges are busy or waiting.
+// Without it, these macros expand to nothing, so tracing costs nothing.
+#ifdef SHAKE_TRACE
+    #define SHAKE_TRACE_CONCATENATE_IMPL( a, b ) a##b
+    #define SHAKE_TRACE_CONCATENATE( a, b ) SHAKE_TRACE_CONCATENATE_IMPL( a, b )
+    #define SHAKE_TRACE_SCOPE( category, name ) \
+        const ::shake::TraceScope SHAKE_TRACE_CONCATENATE( shake_trace_scope_, __LINE__ ) { category, name }
+    #define SHAKE_TRACE_THREAD_NAME( name ) \
+        ::shake::Tracer::instance().thread_buffer().set_thread_name( name )
+#else
+    #define SHAKE_TRACE_SCOPE( category, name ) \
+        static_cast<void>( 0 )
+    #define SHAKE_TRACE_THREAD_NAME( name ) \
+        static_cast<void>( 0 )
+#endif
+
+#endif // TRACE_HPP
@@ -2,7 +2,9 @@
 #define TRANSFORM_RANGE_HPP
 
 #include <functional>
+#include <iterator>
 
+#include "instrumentation.hpp"
 #include "range.hpp"
 
 namespace shake {
@@ -20,13 +22,16 @@ public:
 
 public:
     // iterator traits
-    using iterator_category = std::random_access_iterator_tag;
+    // random-access when the internal iterator is, otherwise std::distance and std::advance fall back to incrementing
+    using iterator_category = typename std::iterator_traits<iterator_t>::iterator_category;
     using value_type        = out_t;
     using difference_type   = std::ptrdiff_t;
     using pointer           = value_type*;
-    using reference         = value_type&;
+    // the transformed values are produced by value
+    using reference         = value_type;
 
 public:
+    TransformIterator() = default;
 
     explicit
     TransformIterator
@@ -40,21 +45,42 @@ public:
 
     const iterator_t& get_internal_iterator() const { return m_iterator; }
 
-    TransformIterator&  operator++()       { ++m_iterator; return *this; }
+    TransformIterator&  operator++()       { SHAKE_COUNT_OPERATION( TransformIterator, "TransformIterator", increments ); ++m_iterator; return *this; }
     TransformIterator   operator++(int)    { TransformIterator result = *this; ++(*this); return result; }
 
-    bool operator==(TransformIterator other) const { return get_internal_iterator() == other.get_internal_iterator(); }
-    bool operator!=(TransformIterator other) const { return !(*this == other); }
+    // Only available when the internal iterator supports them, like its iterator_category says
+    TransformIterator&  operator--()                        { --m_iterator; return *this; }
+    TransformIterator   operator--(int)                     { TransformIterator result = *this; --(*this); return result; }
+    TransformIterator&  operator+=(difference_type n)       { m_iterator += n; return *this; }
+    TransformIterator&  operator-=(difference_type n)       { m_iterator -= n; return *this; }
+    TransformIterator   operator+ (difference_type n) const { return TransformIterator { m_iterator + n, m_functor }; }
+    TransformIterator   operator- (difference_type n) const { return TransformIterator { m_iterator - n, m_functor }; }
+    difference_type     operator- (const TransformIterator& other) const { return m_iterator - other.m_iterator; }
+
+    bool operator==(const TransformIterator& other) const { SHAKE_COUNT_OPERATION( TransformIterator, "TransformIterator", comparisons ); return get_internal_iterator() == other.get_internal_iterator(); }
+    bool operator!=(const TransformIterator& other) const { return !(*this == other); }
+    bool operator< (const TransformIterator& other) const { return get_internal_iterator() <  other.get_internal_iterator(); }
+    bool operator> (const TransformIterator& other) const { return get_internal_iterator() >  other.get_internal_iterator(); }
+    bool operator<=(const TransformIterator& other) const { return get_internal_iterator() <= other.get_internal_iterator(); }
+    bool operator>=(const TransformIterator& other) const { return get_internal_iterator() >= other.get_internal_iterator(); }
+
+    friend TransformIterator operator+( difference_type n, const TransformIterator& it ) { return it + n; }
 
     value_type operator*() const
     {
+        SHAKE_COUNT_OPERATION( TransformIterator, "TransformIterator", dereferences );
+        SHAKE_COUNT_OPERATION( TransformIterator, "TransformIterator", invocations );
         // Use the provided function to transforms the types that we iterate over
         return std::invoke( m_functor, *m_iterator );
     }
 
+    value_type operator[](difference_type n) const { return *( *this + n ); }
+
 private:
-    iterator_t         m_iterator;
-    const functor_t    m_functor;
+    iterator_t         m_iterator {};
+    // not const, so that the iterator can be assigned, like iterators should
+    functor_t          m_functor;
+    SHAKE_COUNT_COPIES( TransformIterator, "TransformIterator" );
 };
 
 //----------------------------------------------------------------
@@ -1,20 +1,60 @@
 #ifndef UNIT_TESTS_HPP
 #define UNIT_TESTS_HPP
 
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <cassert>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <list>
 #include <map>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <set>
+#include <span>
+#include <sstream>
+#include <stdexcept>
 #include <vector>
 #include <string>
+#include <thread>
 
+#include "algorithm.hpp"
+#include "allocation_tracking.hpp"
 #include "any_range.hpp"
+#include "cached_range.hpp"
+#include "chain_range.hpp"
+#include "chunk_range.hpp"
+#include "collect.hpp"
+#include "combinatorics_range.hpp"
 #include "combine_range.hpp"
+#include "csv_range.hpp"
+#include "curve_range.hpp"
 #include "enumerate_range.hpp"
+#include "flatten_range.hpp"
 #include "index_range.hpp"
+#include "instrumented_range.hpp"
+#include "line_range.hpp"
 #include "map_range.hpp"
+#include "mapped_range.hpp"
+#include "merge_range.hpp"
+#include "pair_range.hpp"
+#include "prefetch_ahead_range.hpp"
+#include "prefetch_range.hpp"
+#include "product_range.hpp"
 #include "range.hpp"
+#include "sample_range.hpp"
+#include "set_range.hpp"
+#include "static_range.hpp"
 #include "step_range.hpp"
+#include "tiled_range.hpp"
+#include "trace.hpp"
 #include "transform_range.hpp"
+#include "unroll_range.hpp"
+#include "window_range.hpp"
 
 namespace shake {
 namespace unit_tests {
@@ -249,6 +289,1712 @@ inline void test_any_range()
     print_outcome(result, expected_result, "test_any_range");
 }
 
+//----------------------------------------------------------------
+// MAPPED RANGE
+
+// writes the raw bytes of the values to a temporary file, and returns its path
+template<typename T>
+inline std::filesystem::path write_temporary_file( const std::string& file_name, const std::vector<T>& values )
+{
+    const auto path = std::filesystem::temp_directory_path() / file_name;
+    auto stream = std::ofstream { path, std::ios::binary | std::ios::trunc };
+    stream.write( reinterpret_cast<const char*>( values.data() ), static_cast<std::streamsize>( values.size() * sizeof( T ) ) );
+    return path;
+}
+
+inline void test_mapped_records()
+{
+    const auto path = write_temporary_file( "shake_test_mapped_records.bin", std::vector<int> { 3, 1, 4, 1, 5, 9 } );
+    auto result = std::vector<int> { };
+    for ( const auto& value : step( mapped_records<int>( path ), 2 ) )
+    {
+        result.emplace_back( value );
+    }
+    std::filesystem::remove( path );
+    const auto expected_result = std::vector<int> { 3, 4, 5 };
+    print_outcome( result, expected_result, "test_mapped_records" );
+}
+
+inline void test_mapped_records_enumerate_release_behind()
+{
+    const auto path = write_temporary_file( "shake_test_mapped_enumerate.bin", std::vector<double> { 0.5, 1.5, 2.5 } );
+    const auto records = mapped_records<double>( path, MappedAdvice::sequential | MappedAdvice::release_behind );
+    auto result = std::vector<std::string> { };
+    for ( const auto& [ i, d ] : enumerate( records ) )
+    {
+        result.emplace_back( std::to_string( i ) + std::string( " : " ) + std::to_string( d ) );
+    }
+    std::filesystem::remove( path );
+    const auto expected_result = std::vector<std::string>
+    {
+        "0 : 0.500000",
+        "1 : 1.500000",
+        "2 : 2.500000"
+    };
+    print_outcome( result, expected_result, "test_mapped_records_enumerate_release_behind" );
+}
+
+// the file spans several release chunks, and the parts of a split jump into the middle of it
+inline void test_mapped_records_release_behind_chunks()
+{
+    constexpr auto n_records = 3 * MappedRecordIterator<std::int64_t>::release_chunk_size / sizeof( std::int64_t ) + 5;
+    auto values = std::vector<std::int64_t>( n_records );
+    std::iota( values.begin(), values.end(), 0 );
+    const auto path = write_temporary_file( "shake_test_mapped_release_behind.bin", values );
+    const auto records = mapped_records<std::int64_t>( path, MappedAdvice::sequential | MappedAdvice::release_behind );
+    auto result = std::vector<std::int64_t> { };
+    for ( std::size_t part = 0; part < 3; ++part )
+    {
+        result.push_back( reduce( split( records, 3, part ), std::int64_t { 0 }, []( std::int64_t partial, std::int64_t value ) { return partial + value; } ) );
+    }
+    // walking forwards again after jumping back reads the released pages from the file again
+    auto it = records.begin() + static_cast<std::ptrdiff_t>( n_records - 1 );
+    it -= static_cast<std::ptrdiff_t>( n_records / 2 );
+    auto sum = std::int64_t { 0 };
+    for ( ; it != records.end(); ++it )
+    {
+        sum += *it;
+    }
+    result.push_back( sum );
+    std::filesystem::remove( path );
+
+    auto expected_result = std::vector<std::int64_t> { };
+    for ( std::size_t part = 0; part < 3; ++part )
+    {
+        const auto part_values = split( const_range( values ), 3, part );
+        expected_result.push_back( std::accumulate( part_values.begin(), part_values.end(), std::int64_t { 0 } ) );
+    }
+    expected_result.push_back( std::accumulate( values.end() - static_cast<std::ptrdiff_t>( n_records / 2 + 1 ), values.end(), std::int64_t { 0 } ) );
+    print_outcome( result, expected_result, "test_mapped_records_release_behind_chunks" );
+}
+
+//----------------------------------------------------------------
+// LINE RANGE
+
+inline void test_lines_enumerate()
+{
+    const auto buffer = std::string { "zero\none\n\nthree\n" };
+    auto result = std::vector<std::string> { };
+    for ( const auto& [ i, line ] : enumerate( lines( buffer ) ) )
+    {
+        result.emplace_back( std::to_string( i ) + std::string( " : " ) + std::string( line ) );
+    }
+    const auto expected_result = std::vector<std::string>
+    {
+        "0 : zero",
+        "1 : one",
+        "2 : ",
+        "3 : three"
+    };
+    print_outcome( result, expected_result, "test_lines_enumerate" );
+}
+
+// an empty buffer has no lines, also when its data pointer is null
+inline void test_lines_of_empty_buffer()
+{
+    const auto result = std::vector<std::size_t>
+    {
+        to_vector( lines( std::string_view { } ) ).size(),
+        to_vector( lines( std::string { } ) ).size(),
+        to_vector( lines( std::string_view { "last" } ) ).size()
+    };
+    const auto expected_result = std::vector<std::size_t> { 0, 0, 1 };
+    print_outcome( result, expected_result, "test_lines_of_empty_buffer" );
+}
+
+inline void test_file_lines_transform()
+{
+    const auto text = std::string { "a\nbb\nccc" };
+    const auto path = write_temporary_file( "shake_test_file_lines.txt", std::vector<char> { text.begin(), text.end() } );
+    auto result = std::vector<std::size_t> { };
+    const auto line_sizes = transform<std::string_view, std::size_t>
+    (
+        file_lines( path ),
+        []( std::string_view line ) -> std::size_t
+        {
+            return line.size();
+        }
+    );
+    for ( const auto& size : line_sizes )
+    {
+        result.emplace_back( size );
+    }
+    std::filesystem::remove( path );
+    const auto expected_result = std::vector<std::size_t> { 1, 2, 3 };
+    print_outcome( result, expected_result, "test_file_lines_transform" );
+}
+
+inline void test_stream_lines_small_buffer()
+{
+    // the buffer is smaller than most lines, so it has to be refilled and grown while iterating
+    auto stream = std::istringstream { "first line\nsecond\n\na much longer third line" };
+    auto result = std::vector<std::string> { };
+    for ( const auto& line : lines( stream, 4 ) )
+    {
+        result.emplace_back( line );
+    }
+    const auto expected_result = std::vector<std::string> { "first line", "second", "", "a much longer third line" };
+    print_outcome( result, expected_result, "test_stream_lines_small_buffer" );
+}
+
+//----------------------------------------------------------------
+// CSV RANGE
+
+inline void test_csv_rows_quoted_fields()
+{
+    const auto buffer = std::string { "name,comment\r\nann,\"likes a, b\"\nbob,\"two\nlines\"\n" };
+    auto result = std::vector<std::string> { };
+    for ( const auto& row : csv_rows( buffer ) )
+    {
+        auto joined = std::string { };
+        for ( const auto& field : row.fields() )
+        {
+            joined += std::string( "[" ) + std::string( field ) + std::string( "]" );
+        }
+        result.emplace_back( joined );
+    }
+    const auto expected_result = std::vector<std::string>
+    {
+        "[name][comment]",
+        "[ann][likes a, b]",
+        "[bob][two\nlines]"
+    };
+    print_outcome( result, expected_result, "test_csv_rows_quoted_fields" );
+}
+
+inline void test_csv_columns_parse_field()
+{
+    const auto buffer = std::string { "1\tx\t2.5\n2\ty\t-0.5\n3\tz\t1e1" };
+    const auto rows = tsv_rows( buffer );
+    auto result = std::vector<double> { };
+    for ( const auto& [ id, value ] : combine( column( rows, 0 ), column( rows, 2 ) ) )
+    {
+        result.emplace_back( *parse_field<int>( id ) * *parse_field<double>( value ) );
+    }
+    const auto expected_result = std::vector<double> { 2.5, -1.0, 30.0 };
+    print_outcome( result, expected_result, "test_csv_columns_parse_field" );
+}
+
+inline void test_csv_rows_split_by_offset()
+{
+    // every row should be visited exactly once, no matter where the buffer is split
+    const auto buffer = std::string { "a,1\nbb,22\nccc,333\ndddd,4444\n" };
+    const auto split_offsets = std::vector<std::size_t> { 0, 3, 4, 11, 12, buffer.size() };
+    auto result = std::vector<std::string> { };
+    for ( std::size_t part = 0; part + 1 < split_offsets.size(); ++part )
+    {
+        for ( const auto& row : csv_rows( buffer, split_offsets[ part ], split_offsets[ part + 1 ] ) )
+        {
+            result.emplace_back( row[ 0 ] );
+        }
+    }
+    const auto expected_result = std::vector<std::string> { "a", "bb", "ccc", "dddd" };
+    print_outcome( result, expected_result, "test_csv_rows_split_by_offset" );
+}
+
+//----------------------------------------------------------------
+// PREFETCH RANGE
+
+inline void test_prefetched_index_range()
+{
+    // small batches and a shallow ring, so that the producer has to wait for the consumer
+    auto result = std::size_t { 0 };
+    for ( const auto& i : prefetched( range( 10000 ), 2, 7 ) )
+    {
+        result += i;
+    }
+    const auto expected_result = std::size_t { 49995000 };
+    print_outcome( result, expected_result, "test_prefetched_index_range" );
+}
+
+inline void test_prefetched_stream_lines()
+{
+    // the stream lines are views into a reused buffer, so they are turned into strings before prefetching
+    auto stream = std::istringstream { "one\ntwo\nthree\n" };
+    const auto owned_lines = transform<std::string_view, std::string>
+    (
+        lines( stream, 4 ),
+        []( std::string_view line ) -> std::string
+        {
+            return std::string( line );
+        }
+    );
+    auto result = std::vector<std::string> { };
+    for ( const auto& line : prefetched( owned_lines ) )
+    {
+        result.emplace_back( line );
+    }
+    const auto expected_result = std::vector<std::string> { "one", "two", "three" };
+    print_outcome( result, expected_result, "test_prefetched_stream_lines" );
+}
+
+//----------------------------------------------------------------
+// ITERATOR CATEGORIES
+
+// the built-in iterators satisfy the iterator concepts of the categories they claim,
+// so that the sizes of their ranges are known up front, and they work with std::ranges algorithms
+using vector_iterator_t = std::vector<int>::const_iterator;
+static_assert( std::random_access_iterator<StepIterator<IndexIterator>> );
+static_assert( std::random_access_iterator<StepIterator<vector_iterator_t>> );
+static_assert( std::bidirectional_iterator<StepIterator<std::list<int>::const_iterator>> );
+static_assert( std::random_access_iterator<TransformIterator<std::size_t, int, IndexIterator>> );
+static_assert( std::random_access_iterator<CombineIterator<IndexIterator, vector_iterator_t>> );
+static_assert( std::forward_iterator<CombineIterator<IndexIterator, std::list<int>::const_iterator>> );
+
+inline void test_random_access_operations()
+{
+    const auto ints = std::vector<int> { 10, 20, 30, 40, 50, 60 };
+    const auto stepped = step( const_range( ints ), 2 );
+    const auto combined = combine( range( 6 ), const_range( ints ) );
+    const auto transformed = transform<std::size_t, int>( range( 6 ), []( std::size_t i ) { return static_cast<int>( i * i ); } );
+    auto it = combined.end();
+    it--;
+    const auto result = std::vector<int>
+    {
+        static_cast<int>( range( 3, 9 ).begin()[ 2 ] ),
+        stepped.begin()[ 2 ],
+        *( 1 + stepped.begin() ),
+        transformed.begin()[ 4 ],
+        std::get<1>( combined.begin()[ 3 ] ),
+        std::get<1>( *it ),
+        stepped.end() > stepped.begin() && stepped.begin() <= stepped.begin() && !( transformed.begin() >= transformed.end() ),
+        static_cast<int>( std::ranges::distance( stepped.begin(), stepped.end() ) )
+    };
+    const auto expected_result = std::vector<int> { 5, 50, 30, 16, 40, 60, 1, 3 };
+    print_outcome( result, expected_result, "test_random_access_operations" );
+}
+
+//----------------------------------------------------------------
+// COLLECT
+
+inline void test_to_vector_reserves_once()
+{
+    const auto strings = std::vector<std::string> { "a", "b", "c", "d" };
+    const auto result = to_vector( combine( range( 10 ), step( const_range( strings ), 2 ) ) );
+    // the size of the combined range is known, so exactly enough memory is reserved up front
+    assert( result.capacity() == 2 );
+    const auto expected_result = std::vector<std::tuple<std::size_t, std::string>> { { 0, "a" }, { 1, "c" } };
+    print_outcome( result, expected_result, "test_to_vector_reserves_once" );
+}
+
+inline void test_to_vector_moves_rvalue_container()
+{
+    auto strings = std::vector<std::string> { "a long string that does not fit in the small string buffer" };
+    const auto data = strings.front().data();
+    const auto moved = to_vector( std::move( strings ) );
+    // moving the vector hands over the original buffers, nothing is copied
+    const auto result = ( moved.front().data() == data );
+    print_outcome( result, true, "test_to_vector_moves_rvalue_container" );
+}
+
+// a temporary view does not own its elements, so they are copied, not moved
+inline void test_collect_copies_from_rvalue_view()
+{
+    auto strings = std::vector<std::string> { "a long string that does not fit in the small string buffer", "b" };
+    const auto collected = to_vector( std::span<std::string> { strings } );
+    auto copied = std::vector<std::string>( strings.size() );
+    copy_into( std::span<std::string> { strings }, copied.begin() );
+    auto result = std::vector<std::string> { strings };
+    result.insert( result.end(), collected.begin(), collected.end() );
+    result.insert( result.end(), copied.begin(), copied.end() );
+    auto expected_result = std::vector<std::string> { };
+    for ( int i = 0; i < 3; ++i )
+    {
+        expected_result.insert( expected_result.end(), { "a long string that does not fit in the small string buffer", "b" } );
+    }
+    print_outcome( result, expected_result, "test_collect_copies_from_rvalue_view" );
+}
+
+inline void test_collect_and_copy_into()
+{
+    auto ints = std::vector<int> { 3, 1, 3, 2 };
+    const auto set = collect<std::set<int>>( range( ints ) );
+    auto copied = std::vector<int>( ints.size() );
+    const auto copied_end = copy_into( range( ints ), copied.data() );
+    assert( copied_end == copied.data() + ints.size() );
+    const auto result = to_vector( combine( range( set ), range( copied ) ) );
+    const auto expected_result = std::vector<std::tuple<int, int>> { { 1, 3 }, { 2, 1 }, { 3, 3 } };
+    print_outcome( result, expected_result, "test_collect_and_copy_into" );
+}
+
+//----------------------------------------------------------------
+// CACHED RANGE
+
+inline void test_cached_transform_evaluates_once()
+{
+    auto n_calls = std::atomic<int> { 0 };
+    const auto counted_range = cached
+    (
+        transform<const std::size_t&, std::string>
+        (
+            range( 100 ),
+            [ &n_calls ]( const std::size_t& i ) -> std::string
+            {
+                ++n_calls;
+                return std::to_string( i );
+            }
+        )
+    );
+
+    // iterate concurrently from two threads, and then once more, but compute every value only once
+    const auto concatenate = [ &counted_range ]()
+    {
+        auto result = std::string { };
+        for ( const auto& s : counted_range )
+        {
+            result += s;
+        }
+        return result;
+    };
+    auto concurrent_result = std::string { };
+    auto thread = std::thread( [ & ]() { concurrent_result = concatenate(); } );
+    const auto result = concatenate();
+    thread.join();
+    assert( result == concurrent_result );
+    assert( result == concatenate() );
+    assert( *( std::begin( counted_range ) + 42 ) == "42" );
+
+    print_outcome( n_calls.load(), 100, "test_cached_transform_evaluates_once" );
+}
+
+inline void test_cached_transform_budget()
+{
+    auto n_calls = 0;
+    const auto counted_range = cached
+    (
+        transform<const std::size_t&, std::size_t>
+        (
+            range( 4 ),
+            [ &n_calls ]( const std::size_t& i ) -> std::size_t
+            {
+                ++n_calls;
+                return i * i;
+            }
+        ),
+        2
+    );
+    auto result = std::vector<std::size_t> { };
+    for ( std::size_t pass = 0; pass < 2; ++pass )
+    {
+        for ( const auto& value : counted_range )
+        {
+            result.emplace_back( value );
+        }
+    }
+    // only the first two values are remembered, so the last two are computed in both passes
+    assert( n_calls == 2 + 2 * 2 );
+    const auto expected_result = std::vector<std::size_t> { 0, 1, 4, 9, 0, 1, 4, 9 };
+    print_outcome( result, expected_result, "test_cached_transform_budget" );
+}
+
+//----------------------------------------------------------------
+// INSTRUMENTED RANGE
+
+inline void test_instrumented_range_counts()
+{
+    auto ints = std::vector<int> { 1, 2, 3 };
+    auto strings = std::vector<std::string> { "a", "b", "c" };
+    auto n_characters = std::size_t { 0 };
+    for ( const auto& [ i, s ] : instrumented( combine( range( ints ), range( strings ) ), "test_combine" ) )
+    {
+        n_characters += s.size() * static_cast<std::size_t>( i );
+    }
+    assert( n_characters == 6 );
+
+    auto& counts = InstrumentationRegistry::instance().counts( "test_combine" );
+    const auto result = std::vector<std::uint64_t>
+    {
+        counts.increments.load(), counts.dereferences.load(), counts.comparisons.load()
+    };
+    // reset, so that these counts are not reported when the tests exit
+    InstrumentationRegistry::instance().reset();
+    // one comparison per element, plus the final one that ends the loop
+    const auto expected_result = std::vector<std::uint64_t> { 3, 3, 4 };
+    print_outcome( result, expected_result, "test_instrumented_range_counts" );
+}
+
+// the wrapper is as random-access as the iterator it wraps
+inline void test_instrumented_range_random_access()
+{
+    const auto ints = std::vector<int> { 1, 2, 3, 4, 5 };
+    const auto wrapped = instrumented( const_range( ints ), "test_random_access" );
+    auto it = std::prev( wrapped.end() );
+    auto result = std::vector<int> { *it, *( it - 2 ), wrapped.begin()[ 1 ], *( 3 + wrapped.begin() ) };
+    --it;
+    it -= 1;
+    result.push_back( *it );
+    result.push_back( wrapped.begin() < it && it <= wrapped.end() - 2 && !( it > wrapped.end() ) );
+    std::reverse( result.begin(), result.end() );
+    const auto reversed = std::vector<int>( std::make_reverse_iterator( wrapped.end() ), std::make_reverse_iterator( wrapped.begin() ) );
+    result.insert( result.end(), reversed.begin(), reversed.end() );
+    InstrumentationRegistry::instance().reset();
+    const auto expected_result = std::vector<int> { 1, 3, 4, 2, 3, 5, 5, 4, 3, 2, 1 };
+    print_outcome( result, expected_result, "test_instrumented_range_random_access" );
+}
+
+//----------------------------------------------------------------
+// TRACE
+
+inline void test_chrome_trace_from_two_threads()
+{
+    auto thread = std::thread( []()
+    {
+        Tracer::instance().thread_buffer().set_thread_name( "test worker" );
+        const auto scope = TraceScope { "test", "worker scope" };
+    } );
+    {
+        const auto scope = TraceScope { "test", "main \"scope\"" };
+    }
+    thread.join();
+
+    auto stream = std::ostringstream { };
+    Tracer::instance().write_chrome_trace( stream );
+    const auto trace = stream.str();
+    const auto result = std::vector<bool>
+    {
+        trace.find( "{\"traceEvents\":[" ) == 0,
+        trace.find( "\"name\":\"worker scope\",\"cat\":\"test\",\"ph\":\"X\"" ) != std::string::npos,
+        trace.find( "\"name\":\"main \\\"scope\\\"\"" ) != std::string::npos,
+        trace.find( "\"args\":{\"name\":\"test worker\"}" ) != std::string::npos
+    };
+    const auto expected_result = std::vector<bool> { true, true, true, true };
+    print_outcome( result, expected_result, "test_chrome_trace_from_two_threads" );
+}
+
+// control characters are escaped, and the events that did not fit in a full buffer are reported
+inline void test_chrome_trace_escapes_and_drops()
+{
+    auto thread = std::thread( []()
+    {
+        Tracer::instance().thread_buffer().set_thread_name( "line\nbreak\ttab\x01" );
+        for ( std::size_t i = 0; i < Tracer::events_per_thread + 3; ++i )
+        {
+            const auto scope = TraceScope { "test", "filling scope" };
+        }
+    } );
+    thread.join();
+
+    auto stream = std::ostringstream { };
+    Tracer::instance().write_chrome_trace( stream );
+    const auto trace = stream.str();
+    const auto dropped_key = std::string { "\"otherData\":{\"dropped_events\":" };
+    const auto dropped_position = trace.find( dropped_key );
+    const auto result = std::vector<bool>
+    {
+        trace.find( "\"args\":{\"name\":\"line\\nbreak\\ttab\\u0001\"}" ) != std::string::npos,
+        trace.find( '\n', trace.find( "line" ) ) > trace.find( "\\u0001" ),
+        dropped_position != std::string::npos && std::stoul( trace.substr( dropped_position + dropped_key.size() ) ) >= 3
+    };
+    const auto expected_result = std::vector<bool> { true, true, true };
+    print_outcome( result, expected_result, "test_chrome_trace_escapes_and_drops" );
+}
+
+//----------------------------------------------------------------
+// ALLOCATIONS
+
+// Returns the number of allocations per element, by iterating over inputs of two sizes,
+// so that the allocations made once per range, like those for creating it, cancel out.
+// Making the inputs is not counted, and neither is a first warm-up iteration,
+// which might allocate once for function-local statics, like the instrumentation counters.
+template<typename make_input_t, typename iterate_t>
+inline double allocations_per_element( make_input_t make_input, iterate_t iterate )
+{
+    constexpr std::size_t n = 64;
+    const auto small_input = make_input( n );
+    const auto large_input = make_input( 2 * n );
+    iterate( small_input );
+    const auto n_small = allocation_tracking::count_allocations( [ & ]() { iterate( small_input ); } );
+    const auto n_large = allocation_tracking::count_allocations( [ & ]() { iterate( large_input ); } );
+    return ( static_cast<double>( n_large ) - static_cast<double>( n_small ) ) / static_cast<double>( n );
+}
+
+inline void test_allocations_are_counted()
+{
+    const auto n_allocations = allocation_tracking::count_allocations( []()
+    {
+        const auto ints = std::vector<int>( 3 );
+        const auto copy = std::make_unique<std::vector<int>>( ints );
+    } );
+    const auto result = std::vector<std::size_t> { allocation_tracking::are_hooks_installed, n_allocations };
+    const auto expected_result = std::vector<std::size_t> { 1, 3 };
+    print_outcome( result, expected_result, "test_allocations_are_counted" );
+}
+
+// The adaptors that only refer to existing elements should never allocate per element.
+// Transforms to a type that owns memory allocate for every element, by design.
+inline void test_allocations_per_element()
+{
+    const auto make_ints = []( std::size_t n )
+    {
+        auto ints = std::vector<int>( n );
+        std::iota( ints.begin(), ints.end(), 0 );
+        return ints;
+    };
+    const auto make_map = []( std::size_t n )
+    {
+        auto map = std::map<int, std::string> { };
+        for ( const auto& i : range( n ) )
+        {
+            map[ static_cast<int>( i ) ] = std::string( 32, 'x' );
+        }
+        return map;
+    };
+    const auto make_csv = []( std::size_t n )
+    {
+        auto csv = std::string { };
+        for ( const auto& i : range( n ) )
+        {
+            csv += std::to_string( i ) + ",\"a, b\",c\n";
+        }
+        return csv;
+    };
+    const auto make_shards = []( std::size_t n )
+    {
+        auto shards = std::vector<std::vector<int>>( n / 2, std::vector<int> { 1, 2 } );
+        shards.push_back( { } );
+        return shards;
+    };
+    auto sum = 0L;
+
+    const auto result = std::vector<double>
+    {
+        allocations_per_element( []( std::size_t n ) { return n; }, [ & ]( std::size_t n )
+        {
+            for ( const auto& i : range( n ) ) { sum += static_cast<long>( i ); }
+        } ),
+        allocations_per_element( make_ints, [ & ]( const auto& ints )
+        {
+            for ( const auto& i : step( const_range( ints ), 2 ) ) { sum += i; }
+        } ),
+        allocations_per_element( make_ints, [ & ]( const auto& ints )
+        {
+            for ( const auto& [ a, b ] : combine( const_range( ints ), const_range( ints ) ) ) { sum += a * b; }
+        } ),
+        allocations_per_element( make_ints, [ & ]( const auto& ints )
+        {
+            for ( const auto& [ index, i ] : enumerate( const_range( ints ) ) ) { sum += static_cast<long>( index ) * i; }
+        } ),
+        allocations_per_element( make_map, [ & ]( const auto& map )
+        {
+            for ( const auto& key : keys( map ) ) { sum += key; }
+        } ),
+        allocations_per_element( make_map, [ & ]( const auto& map )
+        {
+            for ( const auto& value : values( map ) ) { sum += static_cast<long>( value.size() ); }
+        } ),
+        allocations_per_element( make_ints, [ & ]( const auto& ints )
+        {
+            for ( const auto& i : make_any_range( const_range( ints ) ) ) { sum += i; }
+        } ),
+        allocations_per_element( make_csv, [ & ]( const auto& csv )
+        {
+            for ( const auto& line : lines( csv ) ) { sum += static_cast<long>( line.size() ); }
+        } ),
+        allocations_per_element( make_csv, [ & ]( const auto& csv )
+        {
+            for ( const auto& row : csv_rows( csv ) )
+            {
+                for ( const auto& field : row.fields() ) { sum += static_cast<long>( field.size() ); }
+            }
+        } ),
+        allocations_per_element( make_ints, [ & ]( const auto& ints )
+        {
+            const auto squares = cached( transform<const int&, long>( const_range( ints ), []( const int& i ) -> long { return 1L * i * i; } ) );
+            for ( const auto& square : squares ) { sum += square; }
+            for ( const auto& square : squares ) { sum -= square; }
+        } ),
+        allocations_per_element( make_ints, [ & ]( const auto& ints )
+        {
+            // copying the functor copies the offsets, so a transform that copies it per element allocates per element
+            const auto offsets = std::vector<int>( 8, 1 );
+            const auto shifted = transform<const int&, int>( const_range( ints ), [ offsets ]( const int& i ) { return i + offsets[ 0 ]; } );
+            for ( const auto& i : shifted ) { sum += i; }
+        } ),
+        allocations_per_element( make_ints, [ & ]( const auto& ints )
+        {
+            for ( const auto& i : chain( const_range( ints ), const_range( ints ) ) ) { sum += i; }
+        } ),
+        allocations_per_element( make_shards, [ & ]( const auto& shards )
+        {
+            for ( const auto& i : flatten( const_range( shards ) ) ) { sum += i; }
+        } ),
+        allocations_per_element( make_ints, [ & ]( const auto& ints )
+        {
+            for ( const auto& window : windows( const_range( ints ), 3 ) ) { sum += *window.begin(); }
+        } ),
+        allocations_per_element( make_ints, [ & ]( const auto& ints )
+        {
+            for ( const auto& [ i, j ] : product( const_range( ints ), range( 2 ) ) ) { sum += i * static_cast<long>( j ); }
+        } ),
+        allocations_per_element( make_ints, [ & ]( const auto& ints )
+        {
+            for ( const auto& i : set_intersection( const_range( ints ), step( const_range( ints ), 2 ) ) ) { sum += i; }
+            for ( const auto& i : set_union( const_range( ints ), step( const_range( ints ), 2 ) ) ) { sum += i; }
+            for ( const auto& i : set_difference( const_range( ints ), step( const_range( ints ), 2 ) ) ) { sum += i; }
+        } ),
+        allocations_per_element( make_ints, [ & ]( const auto& ints )
+        {
+            for ( const auto& i : merge( const_range( ints ), const_range( ints ) ) ) { sum += i; }
+        } ),
+    };
+    assert( sum != 0 );
+
+    // index, step, combine, enumerate, keys, values (copies a string), any, lines, csv rows, cached,
+    // transform, chain, flatten, windows, product, set operations, merge
+    const auto expected_result = std::vector<double> { 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
+    print_outcome( result, expected_result, "test_allocations_per_element" );
+}
+
+//----------------------------------------------------------------
+// STATIC RANGE
+
+inline void test_static_for_tuple_and_array()
+{
+    const auto tuple = std::tuple<int, double, std::string> { 1, 2.5, "three" };
+    const auto lengths = std::array<std::size_t, 3> { 4, 5, 6 };
+    auto result = std::string { };
+    static_for<3>( [ & ]( auto i )
+    {
+        std::ostringstream stream;
+        stream << std::get<i>( tuple ) << ":" << std::get<i>( lengths ) << " ";
+        result += stream.str();
+    } );
+    const auto [ x, y, z ] = static_range<3>();
+    static_assert( decltype( z )::value == 2, "the bound indices are compile-time constants" );
+    result += std::to_string( x + y + z );
+    const auto expected_result = std::string { "1:4 2.5:5 three:6 3" };
+    print_outcome( result, expected_result, "test_static_for_tuple_and_array" );
+}
+
+// the index, step, combine and enumerate ranges can be used during constant evaluation
+constexpr std::size_t constexpr_sum_of_ranges()
+{
+    auto sum = std::size_t { 0 };
+    for ( const auto& i : static_range<4>() )
+    {
+        sum += i;
+    }
+    for ( const auto& i : step( range( 10 ), 3 ) )
+    {
+        sum += i;
+    }
+    for ( const auto& [ i, j ] : combine( range( 3 ), range( 10, 20 ) ) )
+    {
+        sum += i * j;
+    }
+    static_for<4>( [ & ]( auto i ) { sum += 100 * i; } );
+    return sum;
+}
+
+inline void test_static_range_constant_evaluation()
+{
+    constexpr auto result = constexpr_sum_of_ranges();
+    // 0+1+2+3, 0+3+6+9, 0*10+1*11+2*12, 100*(0+1+2+3)
+    const auto expected_result = std::size_t { 6 + 18 + 35 + 600 };
+    print_outcome( result, expected_result, "test_static_range_constant_evaluation" );
+}
+
+//----------------------------------------------------------------
+// UNROLL RANGE
+
+inline void test_unroll_combine_range_for()
+{
+    auto a = std::vector<int> { 1, 2, 3, 4, 5 };
+    const auto b = std::vector<int> { 10, 20, 30, 40, 50, 60 };
+    for ( auto&& [ x, y ] : unroll<4>( combine( range( a ), const_range( b ) ) ) )
+    {
+        x += y;
+    }
+    const auto expected_result = std::vector<int> { 11, 22, 33, 44, 55 };
+    print_outcome( a, expected_result, "test_unroll_combine_range_for" );
+}
+
+inline void test_unroll_for_each_and_reduce()
+{
+    const auto ints = std::vector<int> { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 };
+    auto visited = std::string { };
+    for_each( unroll<4>( const_range( ints ) ), [ & ]( int i ) { visited += std::to_string( i ); } );
+    const auto result = std::vector<std::string>
+    {
+        visited,
+        // not associative, so that the order in which elements are combined shows
+        reduce( unroll<3>( const_range( ints ) ), std::string { }, []( std::string s, int i ) { return s + std::to_string( i ); } ),
+        std::to_string( reduce( const_range( ints ), 0, []( int sum, int i ) { return sum + i; } ) ),
+        std::to_string( reduce( unroll<8>( enumerate( const_range( ints ) ) ), std::size_t { 0 }, []( std::size_t sum, const auto& pair )
+        {
+            return sum + std::get<0>( pair ) * static_cast<std::size_t>( std::get<1>( pair ) );
+        } ) )
+    };
+    const auto expected_result = std::vector<std::string> { "12345678910", "12345678910", "55", "330" };
+    print_outcome( result, expected_result, "test_unroll_for_each_and_reduce" );
+}
+
+// the terminals stop at the end of a part of an unrolled range, not at the end of the whole range
+inline void test_unroll_split_parts()
+{
+    auto ints = std::vector<int>( 16 );
+    std::iota( ints.begin(), ints.end(), 0 );
+    const auto unrolled = unroll<4>( const_range( ints ) );
+    auto result = std::vector<int> { };
+    for ( std::size_t part = 0; part < 3; ++part )
+    {
+        auto n_visited = 0;
+        for_each( split( unrolled, 3, part ), [ & ]( int ) { ++n_visited; } );
+        result.push_back( n_visited );
+        result.push_back( reduce( split( unrolled, 3, part ), 0, []( int partial, int i ) { return partial + i; } ) );
+    }
+    const auto expected_result = std::vector<int> { 6, 15, 5, 40, 5, 65 };
+    print_outcome( result, expected_result, "test_unroll_split_parts" );
+}
+
+//----------------------------------------------------------------
+// PREFETCH AHEAD RANGE
+
+inline void test_prefetch_ahead_node_based()
+{
+    auto map = std::map<int, std::string> { { 3, "c" }, { 1, "a" }, { 2, "b" } };
+    auto list = std::list<int> { 1, 2, 3, 4, 5 };
+    auto result = std::string { };
+    for ( const auto& key : prefetch_ahead( keys( map ), 2 ) )
+    {
+        result += std::to_string( key );
+    }
+    // distances of zero and beyond the size of the range
+    for ( const auto& distance : { 0, 1, 10 } )
+    {
+        for ( auto&& [ i, value ] : prefetch_ahead( combine( range( 10 ), range( list ) ), static_cast<std::size_t>( distance ) ) )
+        {
+            value += static_cast<int>( i );
+        }
+    }
+    for ( const auto& value : list )
+    {
+        result += " " + std::to_string( value );
+    }
+    const auto expected_result = std::string { "123 1 5 9 13 17" };
+    print_outcome( result, expected_result, "test_prefetch_ahead_node_based" );
+}
+
+inline void test_gather()
+{
+    auto data = std::vector<std::string> { "a", "b", "c", "d" };
+    const auto indices = std::vector<std::size_t> { 3, 0, 3, 2 };
+    auto result = std::string { };
+    for ( const auto& s : gather( const_range( data ), const_range( indices ), 2 ) )
+    {
+        result += s;
+    }
+    for ( auto& s : gather( range( data ), const_range( indices ) ) )
+    {
+        s += "!";
+    }
+    result += " " + data[ 0 ] + data[ 1 ] + data[ 2 ] + data[ 3 ];
+    const auto expected_result = std::string { "dadc a!bc!d!!" };
+    print_outcome( result, expected_result, "test_gather" );
+}
+
+//----------------------------------------------------------------
+// PRODUCT RANGE
+
+inline void test_product_range()
+{
+    const auto letters = std::vector<std::string> { "a", "b" };
+    auto result = std::string { };
+    for ( const auto& [ i, letter, j ] : product( range( 2 ), const_range( letters ), range( 3 ) ) )
+    {
+        result += std::to_string( i ) + letter + std::to_string( j ) + " ";
+    }
+    // empty dimensions make the product empty
+    for ( const auto& element : product( range( 2 ), range( 0 ) ) )
+    {
+        result += std::to_string( std::get<0>( element ) );
+    }
+    const auto expected_result = std::string { "0a0 0a1 0a2 0b0 0b1 0b2 1a0 1a1 1a2 1b0 1b1 1b2 " };
+    print_outcome( result, expected_result, "test_product_range" );
+}
+
+inline void test_product_range_split()
+{
+    auto grid = std::vector<int>( 3 * 5 * 7, 0 );
+    const auto cells = product( range( 3 ), range( 5 ), range( 7 ) );
+    auto part_sizes = std::vector<std::ptrdiff_t> { };
+    for ( const auto& part : range( 4 ) )
+    {
+        const auto part_range = split( cells, 4, part );
+        part_sizes.push_back( std::distance( part_range.begin(), part_range.end() ) );
+        for ( const auto& [ i, j, k ] : part_range )
+        {
+            grid[ ( i * 5 + j ) * 7 + k ] += 1;
+        }
+    }
+    // jumping directly to a flat index gives the same element as incrementing to it
+    // the index iterators dereference to references to their own index, so the iterator should outlive the tuple
+    const auto jumped_iterator = cells.begin() + 52;
+    const auto jumped = *jumped_iterator;
+    auto incremented = cells.begin();
+    for ( std::size_t i = 0; i < 52; ++i )
+    {
+        ++incremented;
+    }
+    const auto result = std::vector<bool>
+    {
+        part_sizes == std::vector<std::ptrdiff_t> { 27, 26, 26, 26 },
+        std::all_of( grid.begin(), grid.end(), []( int n ) { return n == 1; } ),
+        jumped == *incremented && std::get<0>( jumped ) == 1 && std::get<1>( jumped ) == 2 && std::get<2>( jumped ) == 3
+    };
+    const auto expected_result = std::vector<bool> { true, true, true };
+    print_outcome( result, expected_result, "test_product_range_split" );
+}
+
+//----------------------------------------------------------------
+// TILED RANGE
+
+inline void test_range_nd_tiled()
+{
+    auto result = std::string { };
+    for ( const auto& [ i, j ] : range_nd<2>( { 2, 3 } ) )
+    {
+        result += std::to_string( i ) + std::to_string( j ) + " ";
+    }
+    result += "| ";
+    // tiles of 2 by 2, with smaller tiles at the boundaries
+    for ( const auto& [ i, j ] : tiled( range_nd<2>( { 3, 5 } ), { 2, 2 } ) )
+    {
+        result += std::to_string( i ) + std::to_string( j ) + " ";
+    }
+    const auto expected_result = std::string { "00 01 02 10 11 12 | 00 01 10 11 02 03 12 13 04 14 20 21 22 23 24 " };
+    print_outcome( result, expected_result, "test_range_nd_tiled" );
+}
+
+inline void test_tiles_split()
+{
+    const auto sizes = std::array<std::size_t, 3> { 10, 11, 12 };
+    auto visits = std::vector<int>( sizes[ 0 ] * sizes[ 1 ] * sizes[ 2 ], 0 );
+    const auto all_tiles = tiles( range_nd( sizes ), { 3, 4, 5 } );
+    for ( const auto& part : range( 3 ) )
+    {
+        for ( const auto& tile : split( all_tiles, 3, part ) )
+        {
+            for ( const auto& [ i, j, k ] : tile )
+            {
+                visits[ ( i * sizes[ 1 ] + j ) * sizes[ 2 ] + k ] += 1;
+            }
+        }
+    }
+    const auto tile_sizes = default_tile_sizes<2>( { 1000, 3 }, sizeof( double ), 32 << 10 );
+    const auto result = std::vector<std::size_t>
+    {
+        static_cast<std::size_t>( std::distance( all_tiles.begin(), all_tiles.end() ) ),
+        static_cast<std::size_t>( std::all_of( visits.begin(), visits.end(), []( int n ) { return n == 1; } ) ),
+        // 2048 elements fit in half of the cache, but the inner dimension only has 3 elements
+        tile_sizes[ 0 ],
+        tile_sizes[ 1 ]
+    };
+    const auto expected_result = std::vector<std::size_t> { 4 * 3 * 3, 1, 45, 3 };
+    print_outcome( result, expected_result, "test_tiles_split" );
+}
+
+// a part of a product only tiles its own rows
+inline void test_tiles_of_split_product()
+{
+    auto result = std::vector<std::size_t> { };
+    const auto part = split( product( range( 0, 4 ), range( 0, 4 ) ), 2, 1 );
+    for ( const auto& tile : tiles( part, { 2, 2 } ) )
+    {
+        for ( const auto& [ i, j ] : tile )
+        {
+            result.push_back( i * 4 + j );
+        }
+    }
+    for ( const auto& [ i, j ] : tiled( split( product( range( 0, 4 ), range( 0, 4 ) ), 4, 1 ), { 2, 2 } ) )
+    {
+        result.push_back( i * 4 + j );
+    }
+    const auto expected_result = std::vector<std::size_t> { 8, 9, 12, 13, 10, 11, 14, 15, 4, 5, 6, 7 };
+    print_outcome( result, expected_result, "test_tiles_of_split_product" );
+}
+
+// a part that is not a block, like the first 6 of 16 indices, can not be tiled
+inline void test_tiles_reject_non_block()
+{
+    const auto is_rejected = []( const auto& tile_part )
+    {
+        try
+        {
+            tile_part();
+        }
+        catch ( const std::invalid_argument& )
+        {
+            return true;
+        }
+        return false;
+    };
+    const auto part = split( range_nd<2>( { 4, 4 } ), 3, 0 );
+    const auto result = std::vector<bool>
+    {
+        is_rejected( [ & ]() { return tiled( part, { 2, 2 } ); } ),
+        is_rejected( [ & ]() { return tiles( part, { 2, 2 } ); } ),
+        is_rejected( [ & ]() { return tiled( split( range_nd<2>( { 4, 4 } ), 4, 1 ), { 2, 2 } ); } )
+    };
+    const auto expected_result = std::vector<bool> { true, true, false };
+    print_outcome( result, expected_result, "test_tiles_reject_non_block" );
+}
+
+//----------------------------------------------------------------
+// CURVE RANGE
+
+inline void test_morton_and_hilbert_order()
+{
+    auto result = std::string { };
+    for ( const auto& [ x, y ] : morton_range( 4, 4 ) )
+    {
+        result += std::to_string( x ) + std::to_string( y ) + " ";
+    }
+    result += "| ";
+    for ( const auto& [ x, y ] : hilbert_range( 4, 4 ) )
+    {
+        result += std::to_string( x ) + std::to_string( y ) + " ";
+    }
+    const auto expected_result = std::string
+    {
+        "00 10 01 11 20 30 21 31 02 12 03 13 22 32 23 33 | "
+        "00 10 11 01 02 03 13 12 22 23 33 32 31 21 20 30 "
+    };
+    print_outcome( result, expected_result, "test_morton_and_hilbert_order" );
+}
+
+// grids that are not a power of two skip the cells outside of them, also when jumping or splitting
+inline void test_curve_range_random_access()
+{
+    const auto check = []( const auto& curve, std::size_t width, std::size_t height )
+    {
+        auto cells = std::set<std::tuple<std::size_t, std::size_t>> { };
+        auto rank = std::ptrdiff_t { 0 };
+        auto is_consistent = static_cast<std::size_t>( curve.end() - curve.begin() ) == width * height;
+        for ( const auto& part : range( 3 ) )
+        {
+            for ( const auto& cell : split( curve, 3, part ) )
+            {
+                is_consistent = is_consistent && cell == *( curve.begin() + rank ) && std::get<0>( cell ) < width && std::get<1>( cell ) < height;
+                cells.insert( cell );
+                ++rank;
+            }
+        }
+        return is_consistent && cells.size() == width * height;
+    };
+    const auto result = std::vector<bool>
+    {
+        check( morton_range( 5, 3 ), 5, 3 ),
+        check( hilbert_range( 5, 3 ), 5, 3 ),
+        check( hilbert_range( 1, 17 ), 1, 17 ),
+        check( morton_range( 0, 4 ), 0, 4 ),
+        // thin grids, where most of the curve lies outside
+        check( morton_range( 3, 100 ), 3, 100 ),
+        check( hilbert_range( 100, 2 ), 100, 2 )
+    };
+    const auto expected_result = std::vector<bool> { true, true, true, true, true, true };
+    print_outcome( result, expected_result, "test_curve_range_random_access" );
+}
+
+// encoding is the inverse of decoding, at every position of the curve
+inline void test_curve_encode_decode()
+{
+    constexpr unsigned n_bits = 5;
+    auto result = std::vector<bool> { };
+    auto is_morton_inverse = true;
+    auto is_hilbert_inverse = true;
+    for ( std::uint64_t position = 0; position < ( std::uint64_t { 1 } << ( 2 * n_bits ) ); ++position )
+    {
+        is_morton_inverse  = is_morton_inverse  && MortonCurve::encode ( MortonCurve::decode ( position, n_bits ), n_bits ) == position;
+        is_hilbert_inverse = is_hilbert_inverse && HilbertCurve::encode( HilbertCurve::decode( position, n_bits ), n_bits ) == position;
+    }
+    result.push_back( is_morton_inverse );
+    result.push_back( is_hilbert_inverse );
+    // the highest bits of the coordinates end up in the highest bits of the position
+    result.push_back( MortonCurve::encode( { 0xFFFFFFFF, 0 }, 32 ) == 0x5555555555555555 );
+    result.push_back( MortonCurve::decode( 0xAAAAAAAAAAAAAAAA, 32 ).y == 0xFFFFFFFF );
+    const auto expected_result = std::vector<bool> { true, true, true, true };
+    print_outcome( result, expected_result, "test_curve_encode_decode" );
+}
+
+//----------------------------------------------------------------
+// PAIR RANGE
+
+inline void test_pairs()
+{
+    auto result = std::string { };
+    for ( const auto& [ i, j ] : pairs( 4 ) )
+    {
+        result += std::to_string( i ) + std::to_string( j ) + " ";
+    }
+    auto strings = std::vector<std::string> { "a", "b", "c" };
+    for ( auto&& [ first, second ] : pairs( range( strings ) ) )
+    {
+        first += second;
+    }
+    result += strings[ 0 ] + " " + strings[ 1 ] + " " + strings[ 2 ];
+    for ( const auto& [ i, j ] : pairs( 1 ) )
+    {
+        result += "never " + std::to_string( i + j );
+    }
+    const auto expected_result = std::string { "01 02 03 12 13 23 abc bc c" };
+    print_outcome( result, expected_result, "test_pairs" );
+}
+
+inline void test_pairs_split_and_unranking()
+{
+    auto part_sizes = std::vector<std::ptrdiff_t> { };
+    auto n_visits = std::vector<int>( 10 * 10, 0 );
+    const auto all_pairs = pairs( 10 );
+    for ( const auto& part : range( 4 ) )
+    {
+        const auto part_range = split( all_pairs, 4, part );
+        part_sizes.push_back( part_range.end() - part_range.begin() );
+        for ( const auto& [ i, j ] : part_range )
+        {
+            n_visits[ i * 10 + j ] += 1;
+        }
+    }
+    auto is_each_pair_visited_once = true;
+    for ( const auto& [ i, j ] : product( range( 10 ), range( 10 ) ) )
+    {
+        is_each_pair_visited_once = is_each_pair_visited_once && n_visits[ i * 10 + j ] == ( i < j ? 1 : 0 );
+    }
+    // unranking stays exact for ranks beyond the precision of a double
+    const auto n = std::size_t { 1 } << 28;
+    const auto many_pairs = pairs( n );
+    const auto n_pairs = many_pairs.end() - many_pairs.begin();
+    const auto result = std::vector<bool>
+    {
+        part_sizes == std::vector<std::ptrdiff_t> { 12, 11, 11, 11 },
+        is_each_pair_visited_once,
+        n_pairs == static_cast<std::ptrdiff_t>( n * ( n - 1 ) / 2 ),
+        *( many_pairs.end() - 1 ) == std::tuple<std::size_t, std::size_t> { n - 2, n - 1 },
+        *( many_pairs.end() - 2 ) == std::tuple<std::size_t, std::size_t> { n - 3, n - 1 },
+        *( many_pairs.begin() + static_cast<std::ptrdiff_t>( n - 1 ) ) == std::tuple<std::size_t, std::size_t> { 1, 2 },
+        *( many_pairs.begin() + static_cast<std::ptrdiff_t>( n - 2 ) ) == std::tuple<std::size_t, std::size_t> { 0, n - 1 }
+    };
+    const auto expected_result = std::vector<bool>( 7, true );
+    print_outcome( result, expected_result, "test_pairs_split_and_unranking" );
+}
+
+//----------------------------------------------------------------
+// COMBINATORICS RANGE
+
+inline void test_combinations_and_permutations()
+{
+    const auto letters = std::string { "abcd" };
+    auto result = std::string { };
+    for ( const auto& subset : combinations( const_range( letters ), 2 ) )
+    {
+        result += std::string( subset.begin(), subset.end() ) + " ";
+    }
+    result += "| ";
+    const auto three_letters = std::string { "abc" };
+    for ( const auto& permutation : permutations( const_range( three_letters ) ) )
+    {
+        result += std::string( permutation.begin(), permutation.end() ) + " ";
+    }
+    const auto expected_result = std::string { "ab ac ad bc bd cd | abc acb bac bca cab cba " };
+    print_outcome( result, expected_result, "test_combinations_and_permutations" );
+}
+
+// the number of subsets is exact up to the largest ones that fit in 64 bits
+inline void test_combinations_count_large()
+{
+    const auto ints = std::vector<int>( 64 );
+    const auto all_subsets = combinations( const_range( ints ), 32 );
+    const auto result = std::vector<std::uint64_t>
+    {
+        static_cast<std::uint64_t>( all_subsets.end() - all_subsets.begin() ),
+        combinatorics_detail::binomial( 67, 33 ),
+        combinatorics_detail::binomial( 100, 3 ),
+        combinatorics_detail::binomial( 3, 5 )
+    };
+    const auto expected_result = std::vector<std::uint64_t> { 1832624140942590534, 14226520737620288370u, 161700, 0 };
+    print_outcome( result, expected_result, "test_combinations_count_large" );
+}
+
+// unranking gives the same subsets and permutations as incrementing, and iterating does not allocate per subset
+inline void test_combinatorics_unranking_and_allocations()
+{
+    const auto ints = std::vector<int> { 1, 2, 3, 4, 5, 6, 7, 8 };
+    const auto all_subsets = combinations( const_range( ints ), 3 );
+    const auto all_permutations = permutations( const_range( ints ) );
+
+    auto is_unranking_consistent = true;
+    auto rank = std::size_t { 0 };
+    for ( auto it = all_subsets.begin(); it != all_subsets.end(); ++it, ++rank )
+    {
+        is_unranking_consistent = is_unranking_consistent && nth( all_subsets, rank ).get_internal_indices() == it.get_internal_indices();
+    }
+    rank = 0;
+    for ( auto it = all_permutations.begin(); it != all_permutations.end(); ++it, ++rank )
+    {
+        if ( rank % 97 == 0 )
+        {
+            is_unranking_consistent = is_unranking_consistent && nth( all_permutations, rank ).get_internal_indices() == it.get_internal_indices();
+        }
+    }
+
+    const auto count_sums = [ & ]( std::size_t k )
+    {
+        return allocation_tracking::count_allocations( [ & ]()
+        {
+            auto sum = 0L;
+            for ( const auto& subset : combinations( const_range( ints ), k ) )
+            {
+                for ( const auto& i : subset )
+                {
+                    sum += i;
+                }
+            }
+            assert( sum > 0 );
+        } );
+    };
+    // the first iteration registers the labels of the instrumented iterators, which allocates
+    count_sums( 3 );
+    const auto result = std::vector<std::size_t>
+    {
+        static_cast<std::size_t>( all_subsets.end() - all_subsets.begin() ),
+        static_cast<std::size_t>( all_permutations.end() - all_permutations.begin() ),
+        is_unranking_consistent,
+        // 28 and 70 subsets, but only allocations for the begin and end iterators
+        count_sums( 2 ) == count_sums( 4 )
+    };
+    const auto expected_result = std::vector<std::size_t> { 56, 40320, 1, 1 };
+    print_outcome( result, expected_result, "test_combinatorics_unranking_and_allocations" );
+}
+
+//----------------------------------------------------------------
+// CHAIN RANGE
+
+inline void test_chain_range()
+{
+    const auto ints = std::vector<int> { 1, 2, 3 };
+    const auto empty_ints = std::vector<int> { };
+    const auto other_ints = std::list<int> { 4, 5 };
+    const auto chained = chain( const_range( empty_ints ), const_range( ints ), const_range( empty_ints ), const_range( other_ints ) );
+
+    auto result = std::vector<int> { };
+    for ( const auto& i : chained )
+    {
+        result.push_back( i );
+    }
+    // the algorithms iterate over the segments, and collecting reserves for all of them at once
+    result.push_back( reduce( chained, 0, []( int sum, int i ) { return sum + i; } ) );
+    result.push_back( static_cast<int>( to_vector( chained ).size() ) );
+    auto copied = std::vector<int>( 5 );
+    result.push_back( static_cast<int>( copy_into( chained, copied.begin() ) - copied.begin() ) );
+    result.insert( result.end(), copied.begin(), copied.end() );
+    const auto expected_result = std::vector<int> { 1, 2, 3, 4, 5, 15, 5, 5, 1, 2, 3, 4, 5 };
+    print_outcome( result, expected_result, "test_chain_range" );
+}
+
+// splitting a chain gives balanced parts, which are chains themselves that may span multiple segments
+inline void test_chain_range_split()
+{
+    const auto ints = std::vector<int> { 0, 1, 2, 3 };
+    const auto other_ints = std::vector<int> { 4 };
+    const auto more_ints = std::vector<int> { 5, 6, 7, 8, 9 };
+    const auto chained = chain( const_range( ints ), const_range( other_ints ), const_range( more_ints ) );
+
+    auto result = std::vector<int> { };
+    for ( std::size_t part = 0; part < 3; ++part )
+    {
+        for_each( split( chained, 3, part ), [ & ]( int i ) { result.push_back( i ); } );
+        result.push_back( -1 );
+    }
+    const auto expected_result = std::vector<int> { 0, 1, 2, 3, -1, 4, 5, 6, -1, 7, 8, 9, -1 };
+    print_outcome( result, expected_result, "test_chain_range_split" );
+}
+
+// windows and groups over a chain only reach as far as their own end, also when collected or reduced segment by segment
+inline void test_chain_sub_ranges()
+{
+    const auto ints = std::vector<int> { 1, 1, 2 };
+    const auto other_ints = std::vector<int> { 2, 3, 3, 4 };
+    const auto chained = chain( const_range( ints ), const_range( other_ints ) );
+
+    auto result = std::vector<int> { };
+    for ( const auto& window : windows( chained, 2 ) )
+    {
+        result.push_back( static_cast<int>( to_vector( window ).size() ) );
+        result.push_back( reduce( window, 0, []( int partial, int i ) { return partial + i; } ) );
+    }
+    result.push_back( -1 );
+    for ( const auto& [ value, group ] : chunk_by( chained ) )
+    {
+        auto n = 0;
+        for_each( group, [ & ]( int ) { ++n; } );
+        result.push_back( value * 10 + n );
+    }
+    const auto expected_result = std::vector<int> { 2, 2, 2, 3, 2, 4, 2, 5, 2, 6, 2, 7, -1, 12, 22, 32, 41 };
+    print_outcome( result, expected_result, "test_chain_sub_ranges" );
+}
+
+//----------------------------------------------------------------
+// FLATTEN RANGE
+
+inline void test_flatten_range()
+{
+    const auto shards = std::vector<std::vector<int>> { { }, { 1, 2 }, { }, { }, { 3 }, { 4, 5, 6 }, { } };
+    const auto flat = flatten( const_range( shards ) );
+
+    auto result = std::vector<int> { };
+    for ( const auto& i : flat )
+    {
+        result.push_back( i );
+    }
+    result.push_back( static_cast<int>( flat_size( flat ) ) );
+    result.push_back( reduce( flat, 0, []( int sum, int i ) { return sum + i; } ) );
+    const auto collected = to_vector( flat );
+    result.insert( result.end(), collected.begin(), collected.end() );
+    // inner ranges can also be temporary ranges, like the rows of a multi-dimensional index range
+    auto n_indices = 0;
+    for ( const auto& i : flatten( transform<std::size_t, IndexRange>( range( std::size_t { 4 } ), []( std::size_t n ) { return range( n ); } ) ) )
+    {
+        n_indices += static_cast<int>( i ) + 1;
+    }
+    result.push_back( n_indices );
+    const auto expected_result = std::vector<int> { 1, 2, 3, 4, 5, 6, 6, 21, 1, 2, 3, 4, 5, 6, 10 };
+    print_outcome( result, expected_result, "test_flatten_range" );
+}
+
+// splitting balances the number of elements, rather than the number of inner ranges
+inline void test_flatten_range_split()
+{
+    auto shards = std::vector<std::vector<int>> { std::vector<int>( 7 ), { }, { 7, 8 }, { 9 } };
+    std::iota( shards[ 0 ].begin(), shards[ 0 ].end(), 0 );
+    const auto flat = flatten( const_range( shards ) );
+
+    auto result = std::vector<int> { };
+    for ( std::size_t part = 0; part < 4; ++part )
+    {
+        const auto flat_part = split( flat, 4, part );
+        result.push_back( static_cast<int>( flat_size( flat_part ) ) );
+        for ( const auto& i : flat_part )
+        {
+            result.push_back( i );
+        }
+    }
+    // a part can be split again
+    result.push_back( -1 );
+    for_each( split( split( flat, 2, 1 ), 2, 0 ), [ & ]( int i ) { result.push_back( i ); } );
+    const auto expected_result = std::vector<int> { 3, 0, 1, 2, 3, 3, 4, 5, 2, 6, 7, 2, 8, 9, -1, 5, 6, 7 };
+    print_outcome( result, expected_result, "test_flatten_range_split" );
+}
+
+//----------------------------------------------------------------
+// WINDOW RANGE
+
+inline void test_windows()
+{
+    const auto ints = std::vector<int> { 1, 2, 3, 4, 5, 6, 7 };
+    auto result = std::vector<int> { };
+    for ( const auto& window : windows( const_range( ints ), 3 ) )
+    {
+        result.push_back( reduce( window, 0, []( int sum, int i ) { return sum + i; } ) );
+    }
+    // windows of every other element
+    for ( const auto& window : windows( step( const_range( ints ), 2 ), 2 ) )
+    {
+        result.push_back( *window.begin() * 10 + *std::next( window.begin() ) );
+    }
+    const auto all_windows = windows( const_range( ints ), 3 );
+    result.push_back( static_cast<int>( all_windows.end() - all_windows.begin() ) );
+    result.push_back( *( *( all_windows.begin() + 4 ) ).begin() );
+    result.push_back( static_cast<int>( std::distance( windows( const_range( ints ), 8 ).begin(), windows( const_range( ints ), 8 ).end() ) ) );
+    const auto expected_result = std::vector<int> { 6, 9, 12, 15, 18, 13, 35, 57, 5, 5, 0 };
+    print_outcome( result, expected_result, "test_windows" );
+}
+
+// walking backwards from the end starts at the last full window, and walking forwards never moves past the end of the range
+inline void test_windows_from_the_end()
+{
+    const auto ints = std::vector<int> { 1, 2, 3, 4, 5, 6, 7 };
+    auto result = std::vector<int> { };
+    const auto all_windows = windows( const_range( ints ), 3 );
+    for ( auto it = all_windows.end(); it != all_windows.begin(); )
+    {
+        --it;
+        result.push_back( reduce( *it, 0, []( int sum, int i ) { return sum + i; } ) );
+    }
+    const auto last_window = *std::prev( all_windows.end(), 1 );
+    result.push_back( static_cast<int>( last_window.end() - last_window.begin() ) );
+    const auto list = std::list<int> { 1, 2, 3, 4 };
+    for ( const auto& window : windows( const_range( list ), 3 ) )
+    {
+        result.push_back( static_cast<int>( std::distance( window.begin(), window.end() ) ) );
+    }
+    const auto expected_result = std::vector<int> { 18, 15, 12, 9, 6, 3, 3, 3 };
+    print_outcome( result, expected_result, "test_windows_from_the_end" );
+}
+
+// the incremental aggregates agree with aggregating each window from scratch, and do not allocate per window
+inline void test_rolling_aggregates()
+{
+    auto ints = std::vector<int>( 1000 );
+    auto random = 12345u;
+    for ( auto& i : ints )
+    {
+        random = random * 1103515245u + 12345u;
+        i = static_cast<int>( ( random >> 16 ) % 1000 );
+    }
+    constexpr std::size_t window_size = 7;
+
+    auto sums = std::vector<long long> { };
+    auto means = std::vector<double> { };
+    auto minima = std::vector<int> { };
+    auto maxima = std::vector<int> { };
+    for ( const auto& window : windows( const_range( ints ), window_size ) )
+    {
+        sums.push_back( std::accumulate( window.begin(), window.end(), 0LL ) );
+        means.push_back( sums.back() / static_cast<double>( window_size ) );
+        minima.push_back( *std::min_element( window.begin(), window.end() ) );
+        maxima.push_back( *std::max_element( window.begin(), window.end() ) );
+    }
+
+    const auto count_allocations_for = [ & ]( std::size_t n )
+    {
+        return allocation_tracking::count_allocations( [ & ]()
+        {
+            auto sum = 0L;
+            for ( const auto& minimum : rolling( Range { ints.cbegin(), ints.cbegin() + static_cast<std::ptrdiff_t>( n ) }, window_size, rolling_min ) )
+            {
+                sum += minimum;
+            }
+            assert( sum >= 0 );
+        } );
+    };
+    // the largest pair of a zip of two ranges, compared lexicographically
+    auto largest_pairs = std::vector<int> { };
+    const auto tens = std::vector<int> { 1, 3, 3, 2, 1 };
+    const auto ones = std::vector<int> { 5, 1, 2, 9, 9 };
+    for ( const auto& [ ten, one ] : rolling( combine( const_range( tens ), const_range( ones ) ), 2, rolling_max ) )
+    {
+        largest_pairs.push_back( ten * 10 + one );
+    }
+
+    const auto result = std::vector<std::size_t>
+    {
+        to_vector( rolling( const_range( ints ), window_size, rolling_sum ) ) == sums,
+        to_vector( rolling( const_range( ints ), window_size, rolling_mean ) ) == means,
+        to_vector( rolling( const_range( ints ), window_size, rolling_min ) ) == minima,
+        to_vector( rolling( const_range( ints ), window_size, rolling_max ) ) == maxima,
+        count_allocations_for( 100 ) == count_allocations_for( 1000 ),
+        largest_pairs == std::vector<int> { 31, 32, 32, 29 },
+        to_vector( rolling( const_range( ints ), 1001, rolling_sum ) ).empty()
+    };
+    const auto expected_result = std::vector<std::size_t> { 1, 1, 1, 1, 1, 1, 1 };
+    print_outcome( result, expected_result, "test_rolling_aggregates" );
+}
+
+// sums of narrow elements are kept in a wider type, so they do not wrap around or overflow
+inline void test_rolling_sum_of_narrow_elements()
+{
+    const auto bytes = std::vector<std::uint8_t>( 5, 200 );
+    const auto large_ints = std::vector<int>( 4, 2000000000 );
+    const auto sums = to_vector( rolling( const_range( bytes ), 3, rolling_sum ) );
+    const auto means = to_vector( rolling( const_range( large_ints ), 2, rolling_mean ) );
+    const auto large_sums = to_vector( rolling( const_range( large_ints ), 2, rolling_sum ) );
+    const auto result = std::vector<long long> { static_cast<long long>( sums.front() ), static_cast<long long>( sums.back() ), static_cast<long long>( means.front() ), large_sums.back() };
+    const auto expected_result = std::vector<long long> { 600, 600, 2000000000, 4000000000 };
+    print_outcome( result, expected_result, "test_rolling_sum_of_narrow_elements" );
+}
+
+//----------------------------------------------------------------
+// CHUNK RANGE
+
+inline void test_chunk_by()
+{
+    const auto events = std::vector<std::pair<int, char>> { { 1, 'a' }, { 1, 'b' }, { 2, 'c' }, { 5, 'd' }, { 5, 'e' }, { 5, 'f' } };
+    auto result = std::string { };
+    for ( const auto& [ key, group ] : chunk_by( const_range( events ), []( const auto& event ) { return event.first; } ) )
+    {
+        result += std::to_string( key ) + ":";
+        for ( const auto& event : group )
+        {
+            result += event.second;
+        }
+        result += " ";
+    }
+    // runs of consecutive numbers, of which the key is the first number
+    const auto ints = std::vector<int> { 1, 2, 3, 7, 8, 10 };
+    for ( const auto& [ first, group ] : chunk_by( const_range( ints ), []( int a, int b ) { return b == a + 1; } ) )
+    {
+        result += std::to_string( first ) + "+" + std::to_string( std::distance( group.begin(), group.end() ) ) + " ";
+    }
+    // runs of equal elements, which are longer than a SIMD block
+    auto runs = std::vector<int> { };
+    for ( const auto& [ value, length ] : { std::pair { 1, 5 }, { 2, 20 }, { 3, 1 }, { 4, 37 } } )
+    {
+        runs.insert( runs.end(), length, value );
+    }
+    for ( const auto& [ value, group ] : chunk_by( const_range( runs ) ) )
+    {
+        result += std::to_string( value ) + "x" + std::to_string( group.end() - group.begin() ) + " ";
+    }
+    const auto expected_result = std::string { "1:ab 2:c 5:def 1+3 7+2 10+1 1x5 2x20 3x1 4x37 " };
+    print_outcome( result, expected_result, "test_chunk_by" );
+}
+
+// the SIMD scan finds the same runs as comparing one element at a time, and the parts of a split begin at runs
+inline void test_chunk_by_split()
+{
+    auto random = 777u;
+    auto longs = std::vector<long> { };
+    auto chars = std::vector<char> { };
+    while ( longs.size() < 2000 )
+    {
+        random = random * 1103515245u + 12345u;
+        const auto value = static_cast<long>( ( random >> 16 ) % 3 );
+        const auto length = static_cast<std::size_t>( ( random >> 8 ) % 40 ) + 1;
+        longs.insert( longs.end(), length, value - 1 );
+        chars.insert( chars.end(), length, static_cast<char>( 'a' + value ) );
+    }
+    const auto run_lengths = []( const auto& groups )
+    {
+        auto lengths = std::vector<std::size_t> { };
+        for ( const auto& [ key, group ] : groups )
+        {
+            lengths.push_back( static_cast<std::size_t>( std::distance( group.begin(), group.end() ) ) );
+        }
+        return lengths;
+    };
+    const auto list_of_longs = std::list<long>( longs.begin(), longs.end() );
+    const auto lengths = run_lengths( chunk_by( const_range( list_of_longs ) ) );
+
+    auto split_lengths = std::vector<std::size_t> { };
+    auto are_parts_balanced = true;
+    for ( std::size_t part = 0; part < 4; ++part )
+    {
+        const auto part_lengths = run_lengths( split( chunk_by( const_range( longs ) ), 4, part ) );
+        split_lengths.insert( split_lengths.end(), part_lengths.begin(), part_lengths.end() );
+        const auto n_part_elements = std::accumulate( part_lengths.begin(), part_lengths.end(), std::size_t { 0 } );
+        are_parts_balanced = are_parts_balanced && n_part_elements + 80 > longs.size() / 4 && n_part_elements < longs.size() / 4 + 80;
+    }
+    const auto result = std::vector<std::size_t>
+    {
+        run_lengths( chunk_by( const_range( longs ) ) ) == lengths,
+        run_lengths( chunk_by( const_range( chars ) ) ) == lengths,
+        split_lengths == lengths,
+        are_parts_balanced
+    };
+    const auto expected_result = std::vector<std::size_t> { 1, 1, 1, 1 };
+    print_outcome( result, expected_result, "test_chunk_by_split" );
+}
+
+//----------------------------------------------------------------
+// MERGE RANGE
+
+inline void test_merge()
+{
+    const auto a = std::vector<int> { 1, 4, 7, 10 };
+    const auto b = std::vector<int> { 2, 5 };
+    const auto c = std::vector<int> { };
+    const auto d = std::vector<int> { 0, 3, 6, 8, 9 };
+    auto result = to_vector( merge( const_range( a ), const_range( b ), const_range( c ), const_range( d ) ) );
+
+    // many ranges at runtime, sorted in descending order
+    auto shards = std::vector<std::vector<int>>( 21 );
+    auto all_ints = std::vector<int> { };
+    auto random = 99u;
+    for ( auto& shard : shards )
+    {
+        random = random * 1103515245u + 12345u;
+        shard.resize( ( random >> 16 ) % 50 );
+        for ( auto& i : shard )
+        {
+            random = random * 1103515245u + 12345u;
+            i = static_cast<int>( ( random >> 16 ) % 1000 );
+        }
+        std::sort( shard.begin(), shard.end(), std::greater<> { } );
+        all_ints.insert( all_ints.end(), shard.begin(), shard.end() );
+    }
+    std::sort( all_ints.begin(), all_ints.end(), std::greater<> { } );
+    auto shard_ranges = std::vector<Range<std::vector<int>::const_iterator>> { };
+    for ( const auto& shard : shards )
+    {
+        shard_ranges.push_back( const_range( shard ) );
+    }
+    result.push_back( to_vector( merge( shard_ranges, std::greater<> { } ) ) == all_ints );
+    result.push_back( static_cast<int>( to_vector( merge( std::vector<Range<std::vector<int>::const_iterator>> { } ) ).size() ) );
+    const auto expected_result = std::vector<int> { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 1, 0 };
+    print_outcome( result, expected_result, "test_merge" );
+}
+
+// equal keys come out in the order of their ranges, and in their order within a range
+inline void test_stable_merge()
+{
+    const auto a = std::vector<std::pair<int, char>> { { 1, 'a' }, { 2, 'b' }, { 2, 'c' }, { 3, 'd' } };
+    const auto b = std::vector<std::pair<int, char>> { { 1, 'e' }, { 2, 'f' }, { 3, 'g' } };
+    const auto c = std::vector<std::pair<int, char>> { { 0, 'h' }, { 2, 'i' }, { 2, 'j' } };
+    const auto by_key = []( const auto& x, const auto& y ) { return x.first < y.first; };
+    auto result = std::string { };
+    for ( const auto& [ key, name ] : stable_merge( std::vector { const_range( a ), const_range( b ), const_range( c ) }, by_key ) )
+    {
+        result += std::to_string( key ) + name + " ";
+    }
+    const auto expected_result = std::string { "0h 1a 1e 2b 2c 2f 2i 2j 3d 3g " };
+    print_outcome( result, expected_result, "test_stable_merge" );
+}
+
+//----------------------------------------------------------------
+// SET RANGE
+
+inline void test_set_operations()
+{
+    const auto a = std::vector<int> { 1, 2, 2, 2, 4, 6, 9 };
+    const auto b = std::list<int> { 2, 2, 3, 4, 9, 10 };
+    auto result = std::vector<int> { };
+    for ( const auto& i : set_intersection( const_range( a ), const_range( b ) ) )
+    {
+        result.push_back( i );
+    }
+    result.push_back( -1 );
+    for ( const auto& i : set_union( const_range( a ), const_range( b ) ) )
+    {
+        result.push_back( i );
+    }
+    result.push_back( -1 );
+    for ( const auto& i : set_difference( const_range( a ), const_range( b ) ) )
+    {
+        result.push_back( i );
+    }
+    result.push_back( -1 );
+    for ( const auto& i : set_difference( const_range( b ), const_range( a ) ) )
+    {
+        result.push_back( i );
+    }
+    const auto expected_result = std::vector<int> { 2, 2, 4, 9, -1, 1, 2, 2, 2, 3, 4, 6, 9, 10, -1, 1, 2, 6, -1, 3, 10 };
+    print_outcome( result, expected_result, "test_set_operations" );
+}
+
+// galloping and SIMD searches give the same results as the standard algorithms, for ranges of very different sizes
+inline void test_set_operations_skewed()
+{
+    auto random = 4242u;
+    const auto make_sorted = [ & ]( std::size_t size, std::uint32_t max_value )
+    {
+        auto values = std::vector<std::uint32_t>( size );
+        for ( auto& value : values )
+        {
+            random = random * 1103515245u + 12345u;
+            value = ( random >> 8 ) % max_value;
+        }
+        // large values check that unsigned integers are not compared as signed ones
+        values.push_back( 0xFFFFFFF0u + static_cast<std::uint32_t>( size % 7 ) );
+        std::sort( values.begin(), values.end() );
+        return values;
+    };
+    auto is_consistent = std::vector<std::size_t> { };
+    for ( const auto& [ small_size, large_size ] : { std::pair<std::size_t, std::size_t> { 20, 20000 }, { 3000, 4000 }, { 0, 100 } } )
+    {
+        const auto small = make_sorted( small_size, 50000 );
+        const auto large = make_sorted( large_size, 50000 );
+        const auto large_longs = std::vector<long>( large.begin(), large.end() );
+
+        auto expected_intersection = std::vector<std::uint32_t> { };
+        std::set_intersection( small.begin(), small.end(), large.begin(), large.end(), std::back_inserter( expected_intersection ) );
+        auto expected_difference = std::vector<std::uint32_t> { };
+        std::set_difference( large.begin(), large.end(), small.begin(), small.end(), std::back_inserter( expected_difference ) );
+        auto expected_union = std::vector<std::uint32_t> { };
+        std::set_union( small.begin(), small.end(), large.begin(), large.end(), std::back_inserter( expected_union ) );
+
+        is_consistent.push_back
+        (
+            to_vector( set_intersection( const_range( small ), const_range( large ) ) ) == expected_intersection
+            && to_vector( set_intersection( const_range( large ), const_range( small ) ) ) == expected_intersection
+            && to_vector( set_difference( const_range( large ), const_range( small ) ) ) == expected_difference
+            && to_vector( set_union( const_range( small ), const_range( large ) ) ) == expected_union
+            && to_vector( set_intersection( const_range( large_longs ), const_range( small ) ) ) == std::vector<long>( expected_intersection.begin(), expected_intersection.end() )
+        );
+    }
+    const auto expected_result = std::vector<std::size_t> { 1, 1, 1 };
+    print_outcome( is_consistent, expected_result, "test_set_operations_skewed" );
+}
+
+//----------------------------------------------------------------
+// SAMPLE RANGE
+
+// A random engine that counts how often it is called
+struct CountingEngine
+{
+    using result_type = std::mt19937_64::result_type;
+
+    static constexpr result_type min() { return std::mt19937_64::min(); }
+    static constexpr result_type max() { return std::mt19937_64::max(); }
+
+    result_type operator()() { ++*n_calls; return engine(); }
+
+    std::mt19937_64     engine;
+    std::size_t*        n_calls;
+};
+
+inline void test_sample()
+{
+    const auto ints = range( std::size_t { 1000000 } );
+    auto n_calls = std::size_t { 0 };
+    const auto first_sample = sample( ints, 10, CountingEngine { std::mt19937_64 { 7 }, &n_calls } );
+    const auto second_sample = sample( ints, 10, std::mt19937_64 { 7 } );
+    auto sorted_sample = first_sample;
+    std::sort( sorted_sample.begin(), sorted_sample.end() );
+
+    // each of 10 elements should be in a sample of 3 about 30% of the time
+    auto engine = std::mt19937_64 { 1 };
+    auto counts = std::vector<std::size_t>( 10 );
+    for ( std::size_t i = 0; i < 10000; ++i )
+    {
+        for ( const auto& selected : sample( range( std::size_t { 10 } ), 3, engine ) )
+        {
+            ++counts[ selected ];
+        }
+    }
+    const auto [ min_count, max_count ] = std::minmax_element( counts.begin(), counts.end() );
+
+    const auto result = std::vector<std::size_t>
+    {
+        first_sample.size(),
+        first_sample == second_sample,
+        std::adjacent_find( sorted_sample.begin(), sorted_sample.end() ) == sorted_sample.end(),
+        // far fewer calls than elements
+        n_calls < 1000,
+        *min_count > 2800 && *max_count < 3200,
+        sample( range( std::size_t { 5 } ), 10 ).size()
+    };
+    const auto expected_result = std::vector<std::size_t> { 10, 1, 1, 1, 1, 5 };
+    print_outcome( result, expected_result, "test_sample" );
+}
+
+inline void test_bernoulli()
+{
+    const auto ints = range( std::size_t { 100000 } );
+    auto n_calls = std::size_t { 0 };
+    const auto selected = bernoulli( ints, 0.01, CountingEngine { std::mt19937_64 { 3 }, &n_calls } );
+    const auto n_selected = static_cast<std::size_t>( std::distance( selected.begin(), selected.end() ) );
+
+    auto small_selection = std::vector<std::size_t> { };
+    for ( const auto& i : bernoulli( range( std::size_t { 20 } ), 0.5, std::mt19937_64 { 3 } ) )
+    {
+        small_selection.push_back( i );
+    }
+
+    const auto result = std::vector<std::size_t>
+    {
+        n_selected > 900 && n_selected < 1100,
+        // about one call per selected element
+        n_calls < 3 * n_selected,
+        // iterating again, or in another run, selects the same elements
+        to_vector( selected ) == to_vector( bernoulli( ints, 0.01, std::mt19937_64 { 3 } ) ),
+        std::is_sorted( small_selection.begin(), small_selection.end() ) && !small_selection.empty(),
+        to_vector( bernoulli( ints, 0.0 ) ).size(),
+        to_vector( bernoulli( ints, 1.0 ) ).size()
+    };
+    const auto expected_result = std::vector<std::size_t> { 1, 1, 1, 1, 0, 100000 };
+    print_outcome( result, expected_result, "test_bernoulli" );
+}
+
 //----------------------------------------------------------------
 inline void run()
 {
@@ -270,6 +2016,94 @@ inline void run()
     test_transform_range_modifying_int_through_tuple();
 
     test_any_range();
+
+    test_mapped_records();
+    test_mapped_records_enumerate_release_behind();
+    test_mapped_records_release_behind_chunks();
+
+    test_lines_enumerate();
+    test_lines_of_empty_buffer();
+    test_file_lines_transform();
+    test_stream_lines_small_buffer();
+
+    test_csv_rows_quoted_fields();
+    test_csv_columns_parse_field();
+    test_csv_rows_split_by_offset();
+
+    test_prefetched_index_range();
+    test_prefetched_stream_lines();
+
+    test_random_access_operations();
+
+    test_to_vector_reserves_once();
+    test_to_vector_moves_rvalue_container();
+    test_collect_and_copy_into();
+    test_collect_copies_from_rvalue_view();
+
+    test_cached_transform_evaluates_once();
+    test_cached_transform_budget();
+
+    test_instrumented_range_counts();
+    test_instrumented_range_random_access();
+
+    test_chrome_trace_from_two_threads();
+    test_chrome_trace_escapes_and_drops();
+
+    test_allocations_are_counted();
+    test_allocations_per_element();
+
+    test_static_for_tuple_and_array();
+    test_static_range_constant_evaluation();
+
+    test_unroll_combine_range_for();
+    test_unroll_for_each_and_reduce();
+    test_unroll_split_parts();
+
+    test_prefetch_ahead_node_based();
+    test_gather();
+
+    test_product_range();
+    test_product_range_split();
+
+    test_range_nd_tiled();
+    test_tiles_split();
+    test_tiles_of_split_product();
+    test_tiles_reject_non_block();
+
+    test_morton_and_hilbert_order();
+    test_curve_range_random_access();
+    test_curve_encode_decode();
+
+    test_pairs();
+    test_pairs_split_and_unranking();
+
+    test_combinations_and_permutations();
+    test_combinations_count_large();
+    test_combinatorics_unranking_and_allocations();
+
+    test_chain_range();
+    test_chain_range_split();
+    test_chain_sub_ranges();
+
+    test_flatten_range();
+    test_flatten_range_split();
+
+    test_windows();
+    test_windows_from_the_end();
+    test_rolling_aggregates();
+    test_rolling_sum_of_narrow_elements();
+
+    test_chunk_by();
+    test_chunk_by_split();
+
+    test_merge();
+    test_stable_merge();
+
+    test_set_operations();
+    test_set_operations_skewed();
+
+    test_sample();
+    test_bernoulli();
 }
 
 
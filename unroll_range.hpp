@@ -0,0 +1,119 @@
+#ifndef UNROLL_RANGE_HPP
+#define UNROLL_RANGE_HPP
+
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+
+#include "instrumentation.hpp"
+#include "range.hpp"
+
+namespace shake {
+
+//----------------------------------------------------------------
+// Iterates over a random-access range, while counting down the number of remaining elements.
+// Comparing iterators only compares that count, instead of the wrapped iterators,
+// which is a single integer comparison even for a combine range over many ranges.
+// The unroll factor is not used by the iterator itself, but by the terminals in algorithm.hpp,
+// which process that many elements per end check, followed by a loop over the remainder.
+template<std::size_t unroll_factor, typename iterator_t>
+class UnrollIterator
+{
+    static_assert( unroll_factor > 0, "the unroll factor should be positive" );
+
+public:
+    static constexpr std::size_t factor = unroll_factor;
+
+public:
+    // iterator traits
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type        = typename std::iterator_traits<iterator_t>::value_type;
+    using difference_type   = std::ptrdiff_t;
+    using pointer           = typename std::iterator_traits<iterator_t>::pointer;
+    using reference         = typename std::iterator_traits<iterator_t>::reference;
+
+public:
+    constexpr
+    UnrollIterator
+    (
+        const iterator_t&   iterator,
+        difference_type     n_remaining
+    )
+        : m_iterator    { iterator }
+        , m_n_remaining { n_remaining }
+    { }
+
+    constexpr const iterator_t&    get_internal_iterator() const { return m_iterator; }
+    constexpr difference_type      n_remaining()           const { return m_n_remaining; }
+
+    constexpr UnrollIterator&  operator++()       { SHAKE_COUNT_OPERATION( UnrollIterator, "UnrollIterator", increments ); ++m_iterator; --m_n_remaining; return *this; }
+    constexpr UnrollIterator   operator++(int)    { UnrollIterator result = *this; ++(*this); return result; }
+    constexpr UnrollIterator&  operator--()       { --m_iterator; ++m_n_remaining; return *this; }
+    constexpr UnrollIterator   operator--(int)    { UnrollIterator result = *this; --(*this); return result; }
+
+    constexpr UnrollIterator&  operator+=(difference_type n)       { m_iterator += n; m_n_remaining -= n; return *this; }
+    constexpr UnrollIterator&  operator-=(difference_type n)       { return *this += -n; }
+    constexpr UnrollIterator   operator+ (difference_type n) const { UnrollIterator result = *this; return result += n; }
+    constexpr UnrollIterator   operator- (difference_type n) const { UnrollIterator result = *this; return result -= n; }
+    constexpr difference_type  operator- (const UnrollIterator& other) const { return other.m_n_remaining - m_n_remaining; }
+
+    constexpr bool operator==(const UnrollIterator& other) const { SHAKE_COUNT_OPERATION( UnrollIterator, "UnrollIterator", comparisons ); return m_n_remaining == other.m_n_remaining; }
+    constexpr bool operator!=(const UnrollIterator& other) const { return !(*this == other); }
+    constexpr bool operator< (const UnrollIterator& other) const { return m_n_remaining > other.m_n_remaining; }
+
+    constexpr decltype( auto ) operator*() const
+    {
+        SHAKE_COUNT_OPERATION( UnrollIterator, "UnrollIterator", dereferences );
+        return *m_iterator;
+    }
+
+private:
+    iterator_t          m_iterator;
+    difference_type     m_n_remaining;
+    SHAKE_COUNT_COPIES( UnrollIterator, "UnrollIterator" );
+};
+
+//----------------------------------------------------------------
+template<std::size_t unroll_factor, typename iterator_t>
+using UnrollRange = Range<UnrollIterator<unroll_factor, iterator_t>>;
+
+//----------------------------------------------------------------
+template<typename T>
+struct is_unroll_iterator : std::false_type { };
+
+template<std::size_t unroll_factor, typename iterator_t>
+struct is_unroll_iterator<UnrollIterator<unroll_factor, iterator_t>> : std::true_type { };
+
+template<typename T>
+inline constexpr bool is_unroll_iterator_v = is_unroll_iterator<T>::value;
+
+//----------------------------------------------------------------
+// Marks a range to be processed unroll_factor elements at a time by the terminals in algorithm.hpp.
+// The range should be random-access, so that its size is known up front.
+template<std::size_t unroll_factor, typename range_t>
+constexpr UnrollRange<unroll_factor, typename range_t::iterator> unroll
+(
+    range_t input_range
+)
+{
+    using iterator_t = typename range_t::iterator;
+    static_assert
+    (
+        std::is_base_of_v<std::random_access_iterator_tag, typename std::iterator_traits<iterator_t>::iterator_category>,
+        "only random-access ranges can be unrolled, because their size should be known up front"
+    );
+
+    const auto begin_iterator   = std::begin( input_range );
+    const auto end_iterator     = std::end( input_range );
+    const auto size             = static_cast<std::ptrdiff_t>( end_iterator - begin_iterator );
+
+    return Range
+    {
+        UnrollIterator<unroll_factor, iterator_t> { begin_iterator, size },
+        UnrollIterator<unroll_factor, iterator_t> { end_iterator,   0    }
+    };
+}
+
+} // namespace shake
+
+#endif // UNROLL_RANGE_HPP
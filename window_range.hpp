@@ -0,0 +1,383 @@
+#ifndef WINDOW_RANGE_HPP
+#define WINDOW_RANGE_HPP
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "instrumentation.hpp"
+#include "range.hpp"
+
+namespace shake {
+
+//----------------------------------------------------------------
+// Iterates over all windows of a fixed number of consecutive elements of a range,
+// and exposes each window as a range over the original elements, without copying them.
+template<typename iterator_t>
+class WindowIterator
+{
+public:
+    // iterator traits
+    // random-access when the internal iterator is, otherwise std::distance and std::advance fall back to incrementing
+    using iterator_category = std::conditional_t
+    <
+        std::is_base_of_v<std::random_access_iterator_tag, typename std::iterator_traits<iterator_t>::iterator_category>,
+        std::random_access_iterator_tag,
+        std::forward_iterator_tag
+    >;
+    using value_type        = Range<iterator_t>;
+    using difference_type   = std::ptrdiff_t;
+    using pointer           = value_type*;
+    using reference         = value_type;
+
+public:
+    // The window ends window_size elements after its beginning, or at the end of the range, whichever comes first,
+    // so that the window after the last one, which is the end iterator, never moves past the end of the range.
+    WindowIterator
+    (
+        const iterator_t&   begin_iterator,
+        const iterator_t&   range_end_iterator,
+        std::size_t         window_size
+    )
+        : m_begin_iterator      { begin_iterator }
+        , m_end_iterator        { begin_iterator }
+        , m_range_end_iterator  { range_end_iterator }
+        , m_window_size         { static_cast<difference_type>( window_size ) }
+    {
+        for ( difference_type i = 0; i < m_window_size && m_end_iterator != m_range_end_iterator; ++i )
+        {
+            ++m_end_iterator;
+        }
+    }
+
+    const iterator_t& get_internal_iterator() const { return m_begin_iterator; }
+
+    WindowIterator& operator++()
+    {
+        SHAKE_COUNT_OPERATION( WindowIterator, "WindowIterator", increments );
+        ++m_begin_iterator;
+        if ( m_end_iterator != m_range_end_iterator )
+        {
+            ++m_end_iterator;
+        }
+        return *this;
+    }
+
+    WindowIterator operator++(int) { WindowIterator result = *this; ++(*this); return result; }
+
+    // Only available when the internal iterator supports them, like its iterator_category says.
+    // The end of the window is moved along with its beginning, and clamped to the end of the range again.
+    WindowIterator&     operator--()                        { return *this -= 1; }
+    WindowIterator&     operator+=(difference_type n)       { m_begin_iterator += n; m_end_iterator = m_begin_iterator + std::min<difference_type>( m_window_size, m_range_end_iterator - m_begin_iterator ); return *this; }
+    WindowIterator&     operator-=(difference_type n)       { return *this += -n; }
+    WindowIterator      operator+ (difference_type n) const { WindowIterator result = *this; return result += n; }
+    WindowIterator      operator- (difference_type n) const { WindowIterator result = *this; return result -= n; }
+    difference_type     operator- (const WindowIterator& other) const { return m_begin_iterator - other.m_begin_iterator; }
+
+    bool operator==(const WindowIterator& other) const { SHAKE_COUNT_OPERATION( WindowIterator, "WindowIterator", comparisons ); return m_begin_iterator == other.m_begin_iterator; }
+    bool operator!=(const WindowIterator& other) const { return !(*this == other); }
+    bool operator< (const WindowIterator& other) const { return m_begin_iterator < other.m_begin_iterator; }
+
+    value_type operator*() const
+    {
+        SHAKE_COUNT_OPERATION( WindowIterator, "WindowIterator", dereferences );
+        return Range { m_begin_iterator, m_end_iterator };
+    }
+
+private:
+    iterator_t          m_begin_iterator;
+    iterator_t          m_end_iterator;
+    iterator_t          m_range_end_iterator;
+    difference_type     m_window_size;
+    SHAKE_COUNT_COPIES( WindowIterator, "WindowIterator" );
+};
+
+//----------------------------------------------------------------
+template<typename iterator_t>
+using WindowRange = Range<WindowIterator<iterator_t>>;
+
+//----------------------------------------------------------------
+// Iterates over the windows of window_size consecutive elements, like a sliding window.
+// A range of n elements has n - window_size + 1 windows, or none when it is shorter than a window.
+// The window size should be positive.
+template<typename range_t>
+WindowRange<typename range_t::iterator> windows
+(
+    range_t         input_range,
+    std::size_t     window_size
+)
+{
+    using iterator_t = WindowIterator<typename range_t::iterator>;
+
+    const auto begin_iterator   = std::begin( input_range );
+    const auto end_iterator     = std::end( input_range );
+    const auto size             = static_cast<std::size_t>( std::distance( begin_iterator, end_iterator ) );
+
+    // the end iterator is the window after the last one, and both begin at the end when the range is shorter than a window
+    if ( size < window_size )
+    {
+        return Range { iterator_t { end_iterator, end_iterator, window_size }, iterator_t { end_iterator, end_iterator, window_size } };
+    }
+    return Range
+    {
+        iterator_t { begin_iterator,                                                                end_iterator, window_size },
+        iterator_t { std::next( begin_iterator, static_cast<std::ptrdiff_t>( size - window_size + 1 ) ), end_iterator, window_size }
+    };
+}
+
+//----------------------------------------------------------------
+// The aggregates that rolling ranges compute over each window.
+// Each aggregate has a State for the type of the elements, which is updated when an element enters the window,
+// and when it leaves the window again, in the same order as they entered.
+
+namespace window_detail {
+
+// The type that sums of elements are kept in, which is wider than the elements,
+// so that windows of small integers do not wrap around, and windows of ints do not overflow.
+// Other types, like user-defined numbers, are summed in the type that adding them gives.
+template<typename element_t, typename = void>
+struct sum
+{
+    using type = std::remove_cvref_t<decltype( std::declval<const element_t&>() + std::declval<const element_t&>() )>;
+};
+
+template<typename element_t>
+struct sum<element_t, std::enable_if_t<std::is_integral_v<element_t>>>
+{
+    using type = std::conditional_t<std::is_signed_v<element_t>, long long, unsigned long long>;
+};
+
+template<typename element_t>
+struct sum<element_t, std::enable_if_t<std::is_floating_point_v<element_t>>>
+{
+    using type = std::common_type_t<element_t, double>;
+};
+
+template<typename element_t>
+using sum_t = typename sum<element_t>::type;
+
+} // namespace window_detail
+
+// The sum of the elements of the window, which only needs + and -.
+// The sum is wider than the elements, e.g. long long for ints.
+struct RollingSum
+{
+    template<typename element_t>
+    class State
+    {
+    public:
+        using sum_t = window_detail::sum_t<element_t>;
+
+        State( const RollingSum&, std::size_t ) { }
+
+        void push( const element_t& element, std::size_t ) { m_sum = m_sum + element; }
+        void pop( const element_t& element, std::size_t )  { m_sum = m_sum - element; }
+
+        const sum_t& value() const { return m_sum; }
+
+    private:
+        sum_t m_sum {};
+    };
+};
+
+// The mean of the elements of the window, as a double.
+// Like the sum, it is updated incrementally, so for floating-point elements it can differ slightly from a sum of the window.
+struct RollingMean
+{
+    template<typename element_t>
+    class State
+    {
+    public:
+        State( const RollingMean&, std::size_t window_size )
+            : m_window_size { window_size }
+        { }
+
+        void push( const element_t& element, std::size_t ) { m_sum = m_sum + element; }
+        void pop( const element_t& element, std::size_t )  { m_sum = m_sum - element; }
+
+        double value() const { return static_cast<double>( m_sum ) / static_cast<double>( m_window_size ); }
+
+    private:
+        window_detail::sum_t<element_t>     m_sum {};
+        std::size_t                         m_window_size;
+    };
+};
+
+// The element of the window that comes first when sorting by the comparison, which is the minimum for std::less.
+// It keeps a monotonic queue of the elements that can still become the first, which holds at most a window of elements,
+// so each element is pushed and popped at most once, whatever the window size.
+template<typename compare_t>
+struct RollingFirst
+{
+    template<typename element_t>
+    class State
+    {
+    public:
+        // the queue is a ring buffer, allocated once for a whole window,
+        // with a power of two as capacity, so that positions wrap around with a mask instead of a division
+        State( const RollingFirst& aggregate, std::size_t window_size )
+            : m_compare { aggregate.compare }
+            , m_queue   ( window_size > 0 ? std::bit_ceil( window_size ) : 0 )
+            , m_mask    { m_queue.size() - 1 }
+        { }
+
+        void push( const element_t& element, std::size_t position )
+        {
+            // elements that are not before the new element can never be the first again, before they leave the window
+            while ( m_size > 0 && !std::invoke( m_compare, back().second, element ) )
+            {
+                --m_size;
+            }
+            m_queue[ ( m_front + m_size ) & m_mask ].emplace( position, element );
+            ++m_size;
+        }
+
+        void pop( const element_t&, std::size_t position )
+        {
+            if ( m_queue[ m_front ]->first == position )
+            {
+                m_front = ( m_front + 1 ) & m_mask;
+                --m_size;
+            }
+        }
+
+        const element_t& value() const { return m_queue[ m_front ]->second; }
+
+    private:
+        const std::pair<std::size_t, element_t>& back() const { return *m_queue[ ( m_front + m_size - 1 ) & m_mask ]; }
+
+    private:
+        compare_t                                                       m_compare;
+        std::vector<std::optional<std::pair<std::size_t, element_t>>>   m_queue;
+        std::size_t                                                     m_mask;
+        std::size_t                                                     m_front     { 0 };
+        std::size_t                                                     m_size      { 0 };
+    };
+
+    compare_t compare {};
+};
+
+inline constexpr RollingSum                     rolling_sum     { };
+inline constexpr RollingMean                    rolling_mean    { };
+inline constexpr RollingFirst<std::less<>>      rolling_min     { };
+inline constexpr RollingFirst<std::greater<>>   rolling_max     { };
+
+//----------------------------------------------------------------
+// Iterates over the aggregates of all windows of a fixed number of consecutive elements of a range.
+// Moving to the next window only pops the element that leaves it and pushes the element that enters it,
+// so the cost per window does not depend on the window size.
+// Every element is dereferenced twice, once when it enters and once when it leaves the window.
+template<typename iterator_t, typename aggregate_t>
+class RollingIterator
+{
+public:
+    using element_t = std::remove_cvref_t<decltype( *std::declval<const iterator_t&>() )>;
+    using state_t   = typename aggregate_t::template State<element_t>;
+
+public:
+    // iterator traits
+    using iterator_category = std::forward_iterator_tag;
+    using value_type        = std::remove_cvref_t<decltype( std::declval<const state_t&>().value() )>;
+    using difference_type   = std::ptrdiff_t;
+    using pointer           = value_type*;
+    using reference         = value_type;
+
+public:
+    // Starts at the first of n_windows windows, the first of which begins at the iterator
+    RollingIterator
+    (
+        const iterator_t&   iterator,
+        std::size_t         window_size,
+        std::size_t         n_windows,
+        const aggregate_t&  aggregate
+    )
+        : m_front_iterator  { iterator }
+        , m_back_iterator   { iterator }
+        , m_state           { aggregate, n_windows > 0 ? window_size : 0 }
+        , m_window_size     { window_size }
+        , m_n_remaining     { n_windows }
+    {
+        for ( std::size_t position = 0; n_windows > 0 && position < window_size; ++position, ++m_back_iterator )
+        {
+            m_state.push( *m_back_iterator, position );
+        }
+    }
+
+    const iterator_t& get_internal_iterator() const { return m_front_iterator; }
+
+    RollingIterator& operator++()
+    {
+        SHAKE_COUNT_OPERATION( RollingIterator, "RollingIterator", increments );
+        // there is no element after the last window
+        if ( --m_n_remaining > 0 )
+        {
+            m_state.pop( *m_front_iterator, m_front_position );
+            m_state.push( *m_back_iterator, m_front_position + m_window_size );
+            ++m_front_iterator;
+            ++m_back_iterator;
+            ++m_front_position;
+        }
+        return *this;
+    }
+
+    RollingIterator operator++(int) { RollingIterator result = *this; ++(*this); return result; }
+
+    bool operator==(const RollingIterator& other) const { SHAKE_COUNT_OPERATION( RollingIterator, "RollingIterator", comparisons ); return m_n_remaining == other.m_n_remaining; }
+    bool operator!=(const RollingIterator& other) const { return !(*this == other); }
+
+    value_type operator*() const
+    {
+        SHAKE_COUNT_OPERATION( RollingIterator, "RollingIterator", dereferences );
+        return m_state.value();
+    }
+
+private:
+    iterator_t      m_front_iterator;
+    iterator_t      m_back_iterator;
+    state_t         m_state;
+    std::size_t     m_window_size;
+    std::size_t     m_n_remaining;
+    std::size_t     m_front_position    { 0 };
+    SHAKE_COUNT_COPIES( RollingIterator, "RollingIterator" );
+};
+
+//----------------------------------------------------------------
+template<typename iterator_t, typename aggregate_t>
+using RollingRange = Range<RollingIterator<iterator_t, aggregate_t>>;
+
+//----------------------------------------------------------------
+// Iterates over the aggregates of the windows of window_size consecutive elements, like pandas rolling().
+// The aggregate is rolling_sum, rolling_mean, rolling_min, rolling_max, or a RollingFirst with another comparison.
+// A range of n elements has n - window_size + 1 windows, or none when it is shorter than a window.
+// The window size should be positive.
+template<typename range_t, typename aggregate_t>
+RollingRange<typename range_t::iterator, aggregate_t> rolling
+(
+    range_t             input_range,
+    std::size_t         window_size,
+    const aggregate_t&  aggregate
+)
+{
+    using iterator_t = RollingIterator<typename range_t::iterator, aggregate_t>;
+
+    const auto begin_iterator   = std::begin( input_range );
+    const auto end_iterator     = std::end( input_range );
+    const auto size             = static_cast<std::size_t>( std::distance( begin_iterator, end_iterator ) );
+    const auto n_windows        = size < window_size ? 0 : size - window_size + 1;
+
+    return Range
+    {
+        iterator_t { begin_iterator, window_size, n_windows, aggregate },
+        iterator_t { end_iterator,   window_size, 0,         aggregate }
+    };
+}
+
+} // namespace shake
+
+#endif // WINDOW_RANGE_HPP